@@ -0,0 +1,39 @@
+@echo off
+setlocal
+
+REM Find Visual Studio
+set "VSWHERE=%ProgramFiles(x86)%\Microsoft Visual Studio\Installer\vswhere.exe"
+if exist "%VSWHERE%" (
+    for /f "usebackq tokens=*" %%i in (`"%VSWHERE%" -latest -products * -requires Microsoft.VisualStudio.Component.VC.Tools.x86.x64 -property installationPath`) do set "VSINSTALL=%%i"
+)
+
+if not defined VSINSTALL (
+    set "VSINSTALL=C:\Program Files\Microsoft Visual Studio\18\Community"
+)
+
+REM Set up environment
+call "%VSINSTALL%\VC\Auxiliary\Build\vcvars64.bat" >nul 2>&1
+
+echo === Compiling Dazzler test harness ===
+cd /d "%~dp0"
+
+cl /nologo /EHsc /W3 /O2 ^
+    /I z80cpmw ^
+    /D _CRT_SECURE_NO_WARNINGS ^
+    test_dazzler.cpp ^
+    z80cpmw/Dazzler.cpp ^
+    z80cpmw/DazzlerCapture.cpp ^
+    /Fe:test_dazzler.exe ^
+    /link /SUBSYSTEM:CONSOLE
+
+if errorlevel 1 (
+    echo Compilation failed!
+    exit /b 1
+)
+
+echo.
+echo === Running Dazzler tests ===
+echo.
+test_dazzler.exe %*
+
+endlocal
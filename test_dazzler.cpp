@@ -0,0 +1,505 @@
+/*
+ * test_dazzler.cpp - Headless Dazzler render and capture tests, and benchmark
+ * Compile: cl /EHsc /O2 /I z80cpmw test_dazzler.cpp z80cpmw/Dazzler.cpp z80cpmw/DazzlerCapture.cpp /Fe:test_dazzler.exe
+ *
+ * Drives every format register value (normal/X4, 512/2K, color/B&W,
+ * intensity, color mask) over a fixed pseudo-random picture and checks:
+ *   - render() against the per-pixel reference decoder (getPixelColor)
+ *   - render() against golden hashes of the RGBA output
+ *   - dirty-row renderPixels() and the published frame against a full render
+ *   - DazzlerCapture's PNG bytes against golden hashes
+ *   - DazzlerCapture's GIF, LZW-decoded here, against the frames submitted
+ *     (including code size growth and the clear at 4095 entries)
+ * then measures render() throughput per mode.
+ *
+ * Usage: test_dazzler [--no-bench] [--update]
+ *   --update prints fresh golden tables after an intended output change
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Dazzler.h"
+#include "DazzlerCapture.h"
+
+static uint8_t g_memory[65536];
+static int g_failures = 0;
+
+static const uint8_t BASE_PORT = 0x0E;
+static const uint8_t CONTROL_2000 = 0x80 | (0x2000 >> 9);   // Enabled, picture at 2000h
+static const uint8_t CONTROL_FE00 = 0x80 | (0xFE00 >> 9);   // Enabled, picture wraps past FFFFh
+
+// FNV-1a hash of render() output for format values 00h-7Fh, picture at
+// 2000h (regenerate with --update)
+static const uint32_t GOLDEN[128] = {
+    0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f,
+    0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f, 0x06ef3b0f,
+    0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90,
+    0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90, 0x8145ad90,
+    0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011,
+    0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011, 0x99a6d011,
+    0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40,
+    0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40, 0x6ef3bd40,
+    0x1ec31dc5, 0xc7a4ffa5, 0x0c6439c5, 0x636b4305, 0x96d728c5, 0x60d2a745, 0x8840c9c5, 0xa8871205,
+    0xbc3ed8c5, 0x871a1305, 0xaa5d4f25, 0x2146a1c5, 0xba49eaa5, 0xcb97ea45, 0xa3aa1545, 0xba482f45,
+    0x1ec31dc5, 0xb145a4c5, 0x62bc57c5, 0x032b50dd, 0xa58b2585, 0x5e9ca2a5, 0x396ba18d, 0xaa5d4f25,
+    0x60d2a745, 0xdc204c15, 0xae020845, 0x64cb27bd, 0x454ef4b5, 0x1df27065, 0x98017a2d, 0xba482f45,
+    0xf7b69dc5, 0xee5b7f35, 0x501ae34d, 0x56b29a95, 0x44358d05, 0x164021cd, 0x43f5dddd, 0xf23b207d,
+    0x09653265, 0x955eec85, 0x86ccad6d, 0x888856f5, 0x061a47e5, 0xd175ca8d, 0xaf34691d, 0x44706a8d,
+    0xf7b69dc5, 0x5ffb1ab9, 0x9e375bf5, 0x5d396ff9, 0x02e70349, 0x4ef67135, 0x9f42c181, 0x86ccad6d,
+    0x164021cd, 0x8403fc79, 0x4b6d0cc5, 0x93558b11, 0xc7413569, 0x3c86f89d, 0x3221c9c9, 0x44706a8d,
+};
+
+// FNV-1a hash of DazzlerCapture::encodePng() output for PNG_FORMATS
+static const uint8_t PNG_FORMATS[2] = { 0x30, 0x7F };
+static const uint32_t GOLDEN_PNG[2] = { 0x265b2f2d, 0xa985a550 };
+
+static void fillMemory() {
+    // Fixed LCG so every run (and every machine) sees the same picture
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < sizeof(g_memory); i++) {
+        seed = seed * 1103515245 + 12345;
+        g_memory[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void attachMemory(Dazzler& dazzler) {
+    dazzler.setMemoryReadCallback([](uint16_t addr) -> uint8_t {
+        return g_memory[addr];
+    });
+    dazzler.setMemoryBlockReadCallback([](uint16_t addr, uint8_t* dest, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            dest[i] = g_memory[(uint16_t)(addr + i)];
+        }
+    });
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t count) {
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < count; i++) {
+        hash = (hash ^ data[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+static void fail(const char* what, int format) {
+    printf("FAIL: %s (format %02Xh)\n", what, format);
+    g_failures++;
+}
+
+// render() must match getPixelColor() pixel for pixel, in R,G,B,A order
+static bool matchesReference(Dazzler& dazzler, const std::vector<uint8_t>& rgba) {
+    int width = dazzler.getWidth();
+    for (int y = 0; y < dazzler.getHeight(); y++) {
+        for (int x = 0; x < width; x++) {
+            uint32_t argb = dazzler.getPixelColor(x, y);
+            const uint8_t* p = &rgba[((size_t)y * width + x) * 4];
+            if (p[0] != (uint8_t)(argb >> 16) || p[1] != (uint8_t)(argb >> 8) ||
+                p[2] != (uint8_t)argb || p[3] != (uint8_t)(argb >> 24)) {
+                printf("  first mismatch at %d,%d\n", x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void testFormats(bool update, uint32_t* hashes) {
+    printf("=== Format register sweep ===\n");
+
+    Dazzler dazzler(BASE_PORT);
+    attachMemory(dazzler);
+    std::vector<uint8_t> rgba((size_t)Dazzler::MAX_WIDTH * Dazzler::MAX_HEIGHT * 4);
+
+    for (int format = 0; format < 128; format++) {
+        dazzler.portOut(BASE_PORT, CONTROL_2000);
+        dazzler.portOut(BASE_PORT + 1, (uint8_t)format);
+
+        size_t bytes = (size_t)dazzler.getWidth() * dazzler.getHeight() * 4;
+        std::fill(rgba.begin(), rgba.end(), 0xCD);
+        dazzler.render(rgba.data());
+
+        if (!matchesReference(dazzler, rgba)) {
+            fail("render() differs from getPixelColor()", format);
+        }
+        hashes[format] = fnv1a(rgba.data(), bytes);
+        if (!update && hashes[format] != GOLDEN[format]) {
+            fail("render() differs from golden output", format);
+        }
+
+        // Same picture wrapping from FE00h to the bottom of memory
+        dazzler.portOut(BASE_PORT, CONTROL_FE00);
+        dazzler.render(rgba.data());
+        if (!matchesReference(dazzler, rgba)) {
+            fail("render() differs from getPixelColor() across FFFFh", format);
+        }
+    }
+    printf("128 formats checked\n\n");
+}
+
+static void testDirtyRows() {
+    printf("=== Dirty-row rendering and frame publication ===\n");
+
+    static const uint8_t FORMATS[] = { 0x10, 0x30, 0x00, 0x20, 0x4F, 0x6F, 0x45, 0x65 };
+    for (uint8_t format : FORMATS) {
+        fillMemory();
+        Dazzler dazzler(BASE_PORT);
+        attachMemory(dazzler);
+        dazzler.portOut(BASE_PORT, CONTROL_2000);
+        dazzler.portOut(BASE_PORT + 1, format);
+
+        size_t count = (size_t)dazzler.getWidth() * dazzler.getHeight();
+        std::vector<uint32_t> partial(count), full(count);
+        dazzler.renderPixels(partial.data());
+
+        // Publish the starting picture, then change a few scattered rows
+        dazzler.endFrame();
+        DazzlerDirtyRegion region;
+        for (int row : { 0, 5, 31, 32, 77, 127 }) {
+            if (row * 16 >= dazzler.getMemorySize()) continue;
+            region.rows[row >> 6] |= 1ull << (row & 63);
+            for (int i = 0; i < 16; i++) {
+                uint16_t addr = (uint16_t)(0x2000 + row * 16 + i);
+                g_memory[addr] ^= 0x5A;
+                dazzler.onMemoryWrite(addr, g_memory[addr]);
+            }
+        }
+        dazzler.endFrame();
+
+        dazzler.renderPixels(partial.data(), &region);
+        dazzler.renderPixels(full.data());
+        if (partial != full) {
+            fail("dirty-row renderPixels() differs from a full render", format);
+        }
+
+        const DazzlerFrame& frame = dazzler.acquireFrame();
+        if (frame.width != dazzler.getWidth() || frame.pixels != full) {
+            fail("published frame differs from a full render", format);
+        }
+    }
+    printf("%d modes checked\n\n", (int)sizeof(FORMATS));
+}
+
+// A published frame of the fixed picture in the given format
+static DazzlerFrame renderFrame(uint8_t format) {
+    fillMemory();
+    Dazzler dazzler(BASE_PORT);
+    attachMemory(dazzler);
+    dazzler.portOut(BASE_PORT, CONTROL_2000);
+    dazzler.portOut(BASE_PORT + 1, format);
+    dazzler.endFrame();
+    return dazzler.acquireFrame();
+}
+
+static uint32_t readU32BE(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void testPng(bool update, uint32_t* hashes) {
+    printf("=== PNG encoding ===\n");
+
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    for (int i = 0; i < 2; i++) {
+        uint8_t format = PNG_FORMATS[i];
+        DazzlerFrame frame = renderFrame(format);
+        std::vector<uint8_t> png, again;
+        if (!DazzlerCapture::encodePng(frame, png) || !DazzlerCapture::encodePng(frame, again)) {
+            fail("encodePng() failed", format);
+            continue;
+        }
+        if (png != again) {
+            fail("encodePng() is not deterministic", format);
+        }
+
+        // Signature, IHDR with the frame size, IEND last
+        if (png.size() < 8 + 25 + 12 || memcmp(png.data(), SIGNATURE, 8) != 0 ||
+            memcmp(&png[12], "IHDR", 4) != 0 ||
+            readU32BE(&png[16]) != (uint32_t)frame.width || readU32BE(&png[20]) != (uint32_t)frame.height ||
+            memcmp(&png[png.size() - 8], "IEND", 4) != 0) {
+            fail("PNG structure", format);
+        }
+
+        hashes[i] = fnv1a(png.data(), png.size());
+        if (!update && hashes[i] != GOLDEN_PNG[i]) {
+            fail("PNG differs from golden output", format);
+        }
+    }
+    printf("2 frames checked\n\n");
+}
+
+// Decode one GIF image's LZW stream. Counts clear codes and the widest code
+// read so the test can tell the table really filled and reset.
+static bool decodeLzw(const std::vector<uint8_t>& data, int minCodeSize, std::vector<uint8_t>& out,
+                      int& clears, int& widestCode) {
+    const int clearCode = 1 << minCodeSize;
+    const int endCode = clearCode + 1;
+    std::vector<std::vector<uint8_t>> dict;
+    int codeSize = 0;
+    int prev = -1;
+    auto reset = [&] {
+        dict.assign(endCode + 1, {});
+        for (int i = 0; i < clearCode; i++) dict[i] = { (uint8_t)i };
+        codeSize = minCodeSize + 1;
+        prev = -1;
+    };
+    reset();
+    clears = 0;
+    widestCode = 0;
+
+    size_t bitPos = 0;
+    for (;;) {
+        if (bitPos + codeSize > data.size() * 8) return false;
+        int code = 0;
+        for (int i = 0; i < codeSize; i++, bitPos++) {
+            code |= ((data[bitPos >> 3] >> (bitPos & 7)) & 1) << i;
+        }
+        widestCode = std::max(widestCode, codeSize);
+
+        if (code == clearCode) {
+            reset();
+            clears++;
+            continue;
+        }
+        if (code == endCode) return true;
+
+        std::vector<uint8_t> entry;
+        if (code < (int)dict.size() && code != clearCode && code != endCode) {
+            entry = dict[code];
+        } else if (code == (int)dict.size() && prev >= 0) {
+            entry = dict[prev];
+            entry.push_back(dict[prev][0]);
+        } else {
+            return false;
+        }
+        out.insert(out.end(), entry.begin(), entry.end());
+
+        if (prev >= 0 && dict.size() < 4096) {
+            std::vector<uint8_t> added = dict[prev];
+            added.push_back(entry[0]);
+            dict.push_back(std::move(added));
+        }
+        prev = code;
+        if ((int)dict.size() == (1 << codeSize) && codeSize < 12) codeSize++;
+    }
+}
+
+static void testGif() {
+    printf("=== GIF encoding ===\n");
+
+    // Frame 0: 16 colors of noise at full size, enough codes to fill the
+    // table. Frame 1: a real 64x64 picture, scaled up 2x. Frame 2: flat.
+    std::vector<DazzlerFrame> frames(3);
+    uint32_t seed = 0xC0FFEE;
+    frames[0].width = frames[0].height = 128;
+    for (int i = 0; i < 128 * 128; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t c = (seed >> 16) & 15;
+        frames[0].pixels.push_back(0xFF000000 | (c * 0x100F01));
+    }
+    frames[1] = renderFrame(0x30);
+    frames[2].width = frames[2].height = 32;
+    frames[2].pixels.assign(32 * 32, 0xFF00FF00);
+    for (size_t i = 0; i < frames.size(); i++) {
+        frames[i].enabled = true;
+        frames[i].frameNumber = i * 12;
+    }
+
+    const char* path = "test_dazzler_capture.gif";
+    DazzlerCapture capture;
+    std::string error;
+    if (!capture.start(path, DazzlerCapture::Format::Gif, false, error)) {
+        fail("capture start() failed", 0);
+        return;
+    }
+    for (const DazzlerFrame& frame : frames) {
+        capture.submit(frame);
+    }
+    capture.stop();
+    if (capture.framesWritten() != frames.size() || !capture.lastError().empty()) {
+        fail("capture wrote the wrong number of frames", 0);
+    }
+
+    std::vector<uint8_t> gif;
+    if (FILE* f = fopen(path, "rb")) {
+        int ch;
+        while ((ch = fgetc(f)) != EOF) gif.push_back((uint8_t)ch);
+        fclose(f);
+    }
+    remove(path);
+    if (gif.size() < 13 || memcmp(gif.data(), "GIF89a", 6) != 0 || gif.back() != 0x3B) {
+        fail("GIF structure", 0);
+        return;
+    }
+
+    // Walk the blocks; no global palette
+    size_t pos = 13;
+    size_t image = 0;
+    while (pos < gif.size() && gif[pos] != 0x3B) {
+        uint8_t kind = gif[pos++];
+        if (kind == 0x21) {
+            pos++;
+            while (pos < gif.size() && gif[pos]) pos += gif[pos] + 1;
+            pos++;
+            continue;
+        }
+        if (kind != 0x2C || pos + 9 > gif.size() || image >= frames.size()) {
+            fail("GIF block sequence", (int)image);
+            return;
+        }
+
+        int width = gif[pos + 4] | (gif[pos + 5] << 8);
+        int height = gif[pos + 6] | (gif[pos + 7] << 8);
+        int flags = gif[pos + 8];
+        pos += 9;
+        const uint8_t* palette = &gif[pos];
+        pos += (size_t)3 << ((flags & 7) + 1);
+        int minCodeSize = gif[pos++];
+        std::vector<uint8_t> data;
+        while (pos < gif.size() && gif[pos]) {
+            data.insert(data.end(), &gif[pos + 1], &gif[pos + 1] + gif[pos]);
+            pos += gif[pos] + 1;
+        }
+        pos++;
+
+        std::vector<uint8_t> indices;
+        int clears = 0, widestCode = 0;
+        const DazzlerFrame& frame = frames[image];
+        int scale = 128 / std::max(frame.width, frame.height);
+        if (!decodeLzw(data, minCodeSize, indices, clears, widestCode)) {
+            fail("GIF LZW stream does not decode", (int)image);
+        } else if (width != frame.width * scale || height != frame.height * scale ||
+                   indices.size() != (size_t)width * height) {
+            fail("GIF frame size", (int)image);
+        } else {
+            for (size_t i = 0; i < indices.size(); i++) {
+                const uint8_t* rgb = palette + indices[i] * 3;
+                uint32_t color = ((uint32_t)rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+                size_t x = i % width / scale, y = i / width / scale;
+                if (color != (frame.pixels[y * frame.width + x] & 0x00FFFFFF)) {
+                    fail("GIF pixels differ from the frame", (int)image);
+                    break;
+                }
+            }
+        }
+
+        // Noise must grow the codes to 12 bits and clear at 4095 entries
+        if (image == 0 && (widestCode != 12 || clears < 2)) {
+            fail("GIF noise frame never filled the code table", 0);
+        }
+        image++;
+    }
+    if (image != frames.size()) {
+        fail("GIF frame count", (int)image);
+    }
+    printf("%d frames checked\n\n", (int)frames.size());
+}
+
+static void benchmark() {
+    printf("=== render() throughput ===\n");
+
+    struct Mode { uint8_t format; const char* name; };
+    static const Mode MODES[] = {
+        { 0x10, "normal 512 color" },
+        { 0x00, "normal 512 B&W" },
+        { 0x30, "normal 2K  color" },
+        { 0x20, "normal 2K  B&W" },
+        { 0x5F, "X4     512 color" },
+        { 0x4F, "X4     512 B&W" },
+        { 0x7F, "X4     2K  color" },
+        { 0x6F, "X4     2K  B&W" },
+    };
+
+    fillMemory();
+    Dazzler dazzler(BASE_PORT);
+    attachMemory(dazzler);
+    std::vector<uint8_t> rgba((size_t)Dazzler::MAX_WIDTH * Dazzler::MAX_HEIGHT * 4);
+    const auto duration = std::chrono::milliseconds(250);
+
+    printf("%-18s %8s %12s %12s\n", "mode", "pixels", "frames/s", "ref frames/s");
+    for (const Mode& mode : MODES) {
+        dazzler.portOut(BASE_PORT, CONTROL_2000);
+        dazzler.portOut(BASE_PORT + 1, mode.format);
+        int pixels = dazzler.getWidth() * dazzler.getHeight();
+
+        // render(): snapshot plus table expansion
+        long frames = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        while (elapsed < duration) {
+            for (int i = 0; i < 100; i++) {
+                dazzler.render(rgba.data());
+            }
+            frames += 100;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double fps = frames / std::chrono::duration<double>(elapsed).count();
+
+        // Per-pixel reference decoder, for scale
+        long refFrames = 0;
+        volatile uint32_t sink = 0;
+        start = std::chrono::steady_clock::now();
+        elapsed = std::chrono::steady_clock::duration::zero();
+        while (elapsed < duration) {
+            for (int y = 0; y < dazzler.getHeight(); y++) {
+                for (int x = 0; x < dazzler.getWidth(); x++) {
+                    sink = sink + dazzler.getPixelColor(x, y);
+                }
+            }
+            refFrames++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double refFps = refFrames / std::chrono::duration<double>(elapsed).count();
+
+        printf("%-18s %8d %12.0f %12.0f\n", mode.name, pixels, fps, refFps);
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool bench = true;
+    bool update = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bench") == 0) bench = false;
+        else if (strcmp(argv[i], "--update") == 0) update = true;
+    }
+
+    printf("=== Dazzler Render Tests ===\n\n");
+
+    fillMemory();
+    uint32_t hashes[128];
+    uint32_t pngHashes[2];
+    testFormats(update, hashes);
+    testDirtyRows();
+    testPng(update, pngHashes);
+    testGif();
+
+    if (update) {
+        printf("static const uint32_t GOLDEN[128] = {\n");
+        for (int i = 0; i < 128; i += 8) {
+            printf("   ");
+            for (int k = 0; k < 8; k++) {
+                printf(" 0x%08x,", hashes[i + k]);
+            }
+            printf("\n");
+        }
+        printf("};\n");
+        printf("static const uint32_t GOLDEN_PNG[2] = { 0x%08x, 0x%08x };\n\n", pngHashes[0], pngHashes[1]);
+    }
+
+    if (bench) {
+        benchmark();
+    }
+
+    if (g_failures) {
+        printf("%d FAILURES\n", g_failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
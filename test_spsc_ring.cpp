@@ -0,0 +1,130 @@
+/*
+ * test_spsc_ring.cpp - SpscRing tests
+ * Compile: cl /EHsc /O2 /I z80cpmw test_spsc_ring.cpp /Fe:test_spsc_ring.exe
+ *
+ * Single-threaded checks of the ring's index bookkeeping (push/pop across
+ * the wrap point, readSpan/consume, full ring, clear) plus a two-thread
+ * run that checks every element arrives once and in order.
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+
+#include "SpscRing.h"
+
+static int g_failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static void testPushPop() {
+    printf("=== Push/pop across the wrap point ===\n");
+    SpscRing<uint8_t, 16> ring;
+    uint8_t next = 0, expect = 0;
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < 7; i++) check(ring.push(next++), "push");
+        uint8_t value;
+        for (int i = 0; i < 7; i++) {
+            check(ring.pop(value) && value == expect++, "pop order");
+        }
+        check(ring.empty() && !ring.pop(value), "empty after draining");
+    }
+}
+
+static void testFull() {
+    printf("=== Full ring ===\n");
+    SpscRing<uint8_t, 8> ring;
+    uint8_t data[12] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    check(ring.push(data, 12) == 8, "block push stops at capacity");
+    check(!ring.push(data[0]), "push into full ring fails");
+    check(ring.size() == 8, "size of full ring");
+
+    const uint8_t* span;
+    size_t count = ring.readSpan(&span);
+    check(count == 8 && span[0] == 1 && span[7] == 8, "readSpan of full ring");
+    ring.consume(3);
+    check(ring.push(data, 12) == 3, "space freed by consume");
+
+    // Contents now wrap: 4..8 at the end, 1..3 at the start
+    count = ring.readSpan(&span);
+    check(count == 5 && span[0] == 4, "readSpan stops at the wrap point");
+    ring.consume(count);
+    count = ring.readSpan(&span);
+    check(count == 3 && span[0] == 1 && span[2] == 3, "readSpan after the wrap");
+    ring.consume(count);
+    check(ring.empty(), "empty after consuming");
+}
+
+static void testClear() {
+    printf("=== Clear then pop ===\n");
+    SpscRing<uint8_t, 16> ring;
+    uint8_t value;
+
+    // Consumer caches the head while input is pending, then clears
+    for (uint8_t i = 0; i < 5; i++) ring.push(i);
+    check(ring.pop(value) && value == 0, "pop before clear");
+    ring.push(5);
+    ring.push(6);
+    ring.clear();
+    check(ring.empty() && ring.size() == 0, "empty after clear");
+    check(!ring.pop(value), "pop after clear finds nothing");
+    check(ring.empty(), "still empty after failed pop");
+
+    // New input after the clear comes through, and only it
+    ring.push(42);
+    check(ring.pop(value) && value == 42, "pop new input after clear");
+    check(!ring.pop(value) && ring.empty(), "nothing after new input");
+
+    // Clearing an already-empty ring is harmless
+    ring.clear();
+    check(!ring.pop(value) && ring.empty(), "clear of empty ring");
+}
+
+static void testThreads() {
+    printf("=== Producer and consumer threads ===\n");
+    static SpscRing<uint32_t, 1024> ring;
+    const uint32_t COUNT = 1000000;
+
+    std::thread producer([] {
+        for (uint32_t i = 0; i < COUNT;) {
+            if (ring.push(i)) i++;
+        }
+    });
+
+    uint32_t expect = 0;
+    bool ordered = true;
+    while (expect < COUNT) {
+        uint32_t value;
+        if (ring.pop(value)) {
+            if (value != expect) ordered = false;
+            expect++;
+        }
+    }
+    producer.join();
+    check(ordered, "elements arrive once and in order");
+    check(ring.empty(), "empty after the run");
+}
+
+int main() {
+    printf("=== SpscRing Tests ===\n\n");
+
+    testPushPop();
+    testFull();
+    testClear();
+    testThreads();
+
+    printf("\n");
+    if (g_failures) {
+        printf("%d FAILURES\n", g_failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*
+ * test_vt100_parser.cpp - Vt100Parser tests and benchmark
+ * Compile: cl /EHsc /O2 /I z80cpmw test_vt100_parser.cpp z80cpmw/Vt100Parser.cpp /Fe:test_vt100_parser.exe
+ *
+ * Feeds escape sequences through the parser and checks what reaches the
+ * handler:
+ *   - CSI parameters: defaults, empty and saturated values, over-long lists
+ *   - private-mode (prefixed) sequences dispatched whole, nothing printed
+ *   - CAN/SUB aborting a sequence and ESC restarting one
+ *   - OSC strings ended by BEL and by ST
+ *   - the same output whether fed in one block or byte by byte
+ * then measures feed() throughput on plain text, typical screen output
+ * and escape-heavy output.
+ *
+ * Usage: test_vt100_parser [--no-bench]
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Vt100Parser.h"
+
+static int g_failures = 0;
+
+// Records handler calls as a compact trace: printed text as is, controls as
+// ^XX, ESC dispatches as E(<intermediate><final>) and CSI dispatches as
+// C(<prefix><p0,p1,...><intermediate><final>)
+class TraceHandler : public Vt100Handler {
+public:
+    std::string trace;
+    Vt100Params lastParams;
+
+    void print(const char* text, size_t count) override { trace.append(text, count); }
+
+    void execute(uint8_t control) override {
+        char buf[8];
+        snprintf(buf, sizeof(buf), "^%02X", control);
+        trace += buf;
+    }
+
+    void escDispatch(uint8_t finalChar, uint8_t intermediate) override {
+        trace += "E(";
+        if (intermediate) trace += (char)intermediate;
+        trace += (char)finalChar;
+        trace += ')';
+    }
+
+    void csiDispatch(uint8_t finalChar, const Vt100Params& params) override {
+        lastParams = params;
+        trace += "C(";
+        if (params.prefix) trace += (char)params.prefix;
+        for (int i = 0; i < params.count; i++) {
+            if (i) trace += ',';
+            trace += std::to_string(params.values[i]);
+        }
+        if (params.intermediate) trace += (char)params.intermediate;
+        trace += (char)finalChar;
+        trace += ')';
+    }
+};
+
+static std::string parse(const std::string& input) {
+    TraceHandler handler;
+    Vt100Parser parser(handler);
+    parser.feed((const uint8_t*)input.data(), input.size());
+    return handler.trace;
+}
+
+// Checks the trace for input fed whole, then fed one byte at a time
+static void expect(const char* what, const std::string& input, const std::string& trace) {
+    std::string whole = parse(input);
+
+    TraceHandler handler;
+    Vt100Parser parser(handler);
+    for (char ch : input) {
+        parser.feed((uint8_t)ch);
+    }
+
+    if (whole != trace) {
+        printf("FAIL: %s\n  expected \"%s\"\n  got      \"%s\"\n", what, trace.c_str(), whole.c_str());
+        g_failures++;
+    } else if (handler.trace != trace) {
+        printf("FAIL: %s (byte by byte)\n  got \"%s\"\n", what, handler.trace.c_str());
+        g_failures++;
+    }
+}
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static void testCsiParams() {
+    printf("=== CSI parameters ===\n");
+
+    expect("no parameters", "\x1b[H", "C(H)");
+    expect("one parameter", "\x1b[5A", "C(5A)");
+    expect("two parameters", "\x1b[12;40H", "C(12,40H)");
+    expect("empty first parameter", "\x1b[;5H", "C(0,5H)");
+    expect("empty middle parameter", "\x1b[1;;3m", "C(1,0,3m)");
+    expect("only separators", "\x1b[;H", "C(0,0H)");
+    expect("leading zeros", "\x1b[007m", "C(7m)");
+    expect("value saturates", "\x1b[99999999m", "C(65535m)");
+    expect("intermediate byte", "\x1b[2 q", "C(2 q)");
+
+    // get() treats missing and 0 alike as the default
+    TraceHandler handler;
+    Vt100Parser parser(handler);
+    const char* seq = "\x1b[;7H";
+    parser.feed((const uint8_t*)seq, strlen(seq));
+    check(handler.lastParams.get(0, 1) == 1 && handler.lastParams.get(1, 1) == 7 &&
+          handler.lastParams.get(2, 1) == 1, "get() defaults");
+
+    // Past MAX_PARAMS the extras are dropped, the kept ones intact
+    std::string longList = "\x1b[";
+    std::string kept;
+    for (int i = 1; i <= 24; i++) {
+        if (i > 1) longList += ';';
+        longList += std::to_string(i);
+        if (i <= Vt100Params::MAX_PARAMS) {
+            if (i > 1) kept += ',';
+            kept += std::to_string(i);
+        }
+    }
+    longList += "m";
+    expect("over-long parameter list", longList, "C(" + kept + "m)");
+
+    // A sequence after an over-long one starts clean
+    expect("parameters reset after overflow", longList + "\x1b[2J", "C(" + kept + "m)C(2J)");
+
+    // Sub-parameters (':') aren't supported: the sequence is swallowed
+    expect("colon swallows the sequence", "\x1b[38:5:1mX", "X");
+}
+
+static void testPrivateModes() {
+    printf("=== Private-mode sequences ===\n");
+
+    expect("DECTCEM hide cursor", "\x1b[?25l", "C(?25l)");
+    expect("several private modes", "\x1b[?1;7h", "C(?1,7h)");
+    expect("secondary DA", "\x1b[>c", "C(>c)");
+    expect("'=' prefix", "\x1b[=5h", "C(=5h)");
+    expect("'<' prefix", "\x1b[<0;1M", "C(<0,1M)");
+
+    // Nothing of a private sequence leaks into the text around it
+    expect("text around a private sequence", "ab\x1b[?2004hcd", "abC(?2004h)cd");
+
+    // A prefix byte after the parameters makes the sequence invalid: it is
+    // consumed up to its final byte and never dispatched
+    expect("misplaced prefix swallowed", "\x1b[1?hX", "X");
+    expect("parameter after intermediate swallowed", "\x1b[1 2qX", "X");
+}
+
+static void testAbortAndRestart() {
+    printf("=== CAN/SUB and ESC ===\n");
+
+    expect("CAN aborts a CSI sequence", "\x1b[12\x18X", "^18X");
+    expect("SUB aborts a CSI sequence", "\x1b[12\x1aX", "^1AX");
+    expect("CAN aborts an ESC sequence", "\x1b(\x18" "B", "^18B");
+    expect("CAN aborts a string", "\x1b]0;title\x18X", "^18X");
+    expect("ESC restarts a CSI sequence", "\x1b[12\x1b[3A", "C(3A)");
+    expect("ESC restarts with a fresh prefix", "\x1b[?12\x1b[3h", "C(3h)");
+    expect("ESC restarts an ESC sequence", "\x1b(\x1b" "7", "E(7)");
+
+    // Other C0 controls execute in the middle of a sequence without
+    // disturbing it
+    expect("LF inside CSI", "\x1b[1\n2H", "^0AC(12H)");
+    expect("BS inside CSI", "\x1b[\b5A", "^08C(5A)");
+
+    // DEL is ignored everywhere
+    expect("DEL in text", "a\x7f" "b", "ab");
+    expect("DEL inside CSI", "\x1b[1\x7f" "2H", "C(12H)");
+
+    // reset() drops a partial sequence
+    TraceHandler handler;
+    Vt100Parser parser(handler);
+    const char* partial = "\x1b[12;";
+    parser.feed((const uint8_t*)partial, strlen(partial));
+    parser.reset();
+    const char* rest = "3HX";
+    parser.feed((const uint8_t*)rest, strlen(rest));
+    check(handler.trace == "3HX", "reset() drops a partial sequence");
+}
+
+static void testStrings() {
+    printf("=== OSC and other strings ===\n");
+
+    expect("OSC ended by BEL", "\x1b]0;window title\x07" "after", "after");
+    expect("OSC ended by ST", "\x1b]2;window title\x1b\\after", "E(\\)after");
+    expect("controls inside OSC are part of it", "\x1b]0;a\nb\tc\x07X", "X");
+    expect("DCS ended by ST", "\x1bPq#0;2;0;0;0\x1b\\X", "E(\\)X");
+    expect("APC ended by ST", "\x1b_payload\x1b\\X", "E(\\)X");
+    expect("PM ended by ST", "\x1b^payload\x1b\\X", "E(\\)X");
+    expect("SOS ended by ST", "\x1bXpayload\x1b\\X", "E(\\)X");
+    expect("ESC sequences still parse", "\x1b" "7\x1b(B\x1b" "8", "E(7)E((B)E(8)");
+}
+
+// Handler that only counts, so the benchmark measures the parser
+class CountingHandler : public Vt100Handler {
+public:
+    size_t printed = 0, controls = 0, sequences = 0;
+    void print(const char*, size_t count) override { printed += count; }
+    void execute(uint8_t) override { controls++; }
+    void escDispatch(uint8_t, uint8_t) override { sequences++; }
+    void csiDispatch(uint8_t, const Vt100Params&) override { sequences++; }
+};
+
+static void benchmark() {
+    printf("\n=== feed() throughput ===\n");
+
+    const size_t SIZE = 16 * 1024 * 1024;
+    uint32_t seed = 0x12345678;
+    auto next = [&seed] { seed = seed * 1103515245 + 12345; return seed >> 16; };
+
+    // Plain text: 80-column lines
+    std::string text;
+    while (text.size() < SIZE) {
+        for (int i = 0; i < 78; i++) text += (char)(0x20 + next() % 95);
+        text += "\r\n";
+    }
+
+    // Typical screen output: words with a colour change or cursor move
+    // now and then, as from a directory listing or an editor redraw
+    std::string screen;
+    while (screen.size() < SIZE) {
+        int len = 3 + next() % 12;
+        for (int i = 0; i < len; i++) screen += (char)('a' + next() % 26);
+        switch (next() % 16) {
+        case 0: screen += "\x1b[1;33m"; break;
+        case 1: screen += "\x1b[0m"; break;
+        case 2: screen += "\x1b[" + std::to_string(1 + next() % 24) + ";" +
+                          std::to_string(1 + next() % 80) + "H"; break;
+        case 3: screen += "\r\n"; break;
+        default: screen += ' '; break;
+        }
+    }
+
+    // Escape-heavy: a cursor move and attribute per character
+    std::string heavy;
+    while (heavy.size() < SIZE) {
+        heavy += "\x1b[" + std::to_string(1 + next() % 24) + ";" + std::to_string(1 + next() % 80) + "H";
+        heavy += "\x1b[" + std::to_string(30 + next() % 8) + "m";
+        heavy += (char)('A' + next() % 26);
+    }
+
+    struct Input { const char* name; const std::string* data; };
+    const Input INPUTS[] = {
+        { "plain text", &text },
+        { "screen output", &screen },
+        { "escape-heavy", &heavy },
+    };
+
+    printf("%-14s %10s %12s\n", "input", "MB", "MB/s");
+    for (const Input& input : INPUTS) {
+        CountingHandler handler;
+        Vt100Parser parser(handler);
+        const uint8_t* data = (const uint8_t*)input.data->data();
+        size_t size = input.data->size();
+
+        // Fed in 4 KB blocks, as the output ring hands it over
+        const size_t BLOCK = 4096;
+        const auto duration = std::chrono::milliseconds(500);
+        size_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        while (elapsed < duration) {
+            for (size_t pos = 0; pos < size; pos += BLOCK) {
+                parser.feed(data + pos, std::min(BLOCK, size - pos));
+            }
+            bytes += size;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double mbps = bytes / (1024.0 * 1024.0) / std::chrono::duration<double>(elapsed).count();
+        printf("%-14s %10.1f %12.0f\n", input.name, size / (1024.0 * 1024.0), mbps);
+        check(handler.printed > 0, "benchmark input printed something");
+    }
+}
+
+int main(int argc, char** argv) {
+    bool bench = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bench") == 0) bench = false;
+    }
+
+    printf("=== Vt100Parser Tests ===\n\n");
+
+    testCsiParams();
+    testPrivateModes();
+    testAbortAndRestart();
+    testStrings();
+
+    if (bench) {
+        benchmark();
+    }
+
+    printf("\n");
+    if (g_failures) {
+        printf("%d FAILURES\n", g_failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
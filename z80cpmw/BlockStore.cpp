@@ -0,0 +1,434 @@
+/*
+ * BlockStore.cpp - Content-Addressed Deduplicated Disk Storage Implementation
+ */
+
+#include "pch.h"
+#include "BlockStore.h"
+#include "EmulatorEngine.h"
+#include <bcrypt.h>
+#include <io.h>
+
+#pragma comment(lib, "bcrypt.lib")
+
+// Force a stdio file's contents to stable storage
+static bool syncFile(FILE* f) {
+    return fflush(f) == 0 && _commit(_fileno(f)) == 0;
+}
+
+// Write a file in full next to path, make it durable, then move it over
+// path, so a crash leaves either the old or the new contents
+static bool replaceFile(const std::string& path, const void* head, size_t headSize,
+                        const void* body, size_t bodySize) {
+    std::string tempPath = path + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) return false;
+
+    bool ok = fwrite(head, headSize, 1, f) == 1 &&
+              (bodySize == 0 || fwrite(body, bodySize, 1, f) == 1) &&
+              syncFile(f);
+    ok = fclose(f) == 0 && ok;
+    if (ok) {
+        ok = MoveFileExA(tempPath.c_str(), path.c_str(),
+                         MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    }
+    if (!ok) {
+        DeleteFileA(tempPath.c_str());
+    }
+    return ok;
+}
+
+BlockStore& BlockStore::instance() {
+    static BlockStore store;
+    return store;
+}
+
+BlockStore::~BlockStore() {
+    if (m_pack) {
+        save();
+        fclose(m_pack);
+    }
+    if (m_algorithm) {
+        BCryptCloseAlgorithmProvider((BCRYPT_ALG_HANDLE)m_algorithm, 0);
+    }
+}
+
+bool BlockStore::ensureOpen() {
+    if (m_opened) return m_pack != nullptr;
+    m_opened = true;
+
+    m_dir = EmulatorEngine::getUserDataDirectory() + "\\blocks";
+    CreateDirectoryA(m_dir.c_str(), nullptr);
+
+    std::string packPath = m_dir + "\\blocks.pack";
+    m_pack = fopen(packPath.c_str(), "r+b");
+    if (!m_pack) {
+        m_pack = fopen(packPath.c_str(), "w+b");
+    }
+    if (!m_pack) return false;
+
+    // A missing or unreadable index starts an empty store; the pack is
+    // then treated as free space
+    std::string indexPath = m_dir + "\\blocks.idx";
+    FILE* f = fopen(indexPath.c_str(), "rb");
+    if (f) {
+        BlockIndexHeader header = {};
+        if (fread(&header, sizeof(header), 1, f) == 1 &&
+            memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+            header.version == VERSION && header.blockSize == BLOCK_SIZE) {
+            std::vector<BlockIndexEntry> entries(header.entryCount);
+            if (entries.empty() ||
+                fread(entries.data(), sizeof(BlockIndexEntry), entries.size(), f) == entries.size()) {
+                m_slotCount = header.slotCount;
+                for (const auto& e : entries) {
+                    if (e.refs > 0 && e.slot < m_slotCount) {
+                        m_entries[e.hash] = { e.slot, e.refs };
+                    }
+                }
+            }
+        }
+        fclose(f);
+    }
+
+    // Rebuild the free list from the slots nothing refers to
+    std::vector<bool> used(m_slotCount, false);
+    for (const auto& e : m_entries) {
+        used[e.second.slot] = true;
+    }
+    for (uint32_t slot = m_slotCount; slot-- > 0;) {
+        if (!used[slot]) m_freeSlots.push_back(slot);
+    }
+    return true;
+}
+
+bool BlockStore::computeHash(const uint8_t* data, Hash& hash) {
+    if (!m_algorithm &&
+        !BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider((BCRYPT_ALG_HANDLE*)&m_algorithm,
+                                                    BCRYPT_SHA256_ALGORITHM, nullptr, 0))) {
+        m_algorithm = nullptr;
+        return false;
+    }
+    return BCRYPT_SUCCESS(BCryptHash((BCRYPT_ALG_HANDLE)m_algorithm, nullptr, 0,
+                                     (PUCHAR)data, BLOCK_SIZE, hash.data(), (ULONG)hash.size()));
+}
+
+bool BlockStore::put(const uint8_t* data, Hash& hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ensureOpen() || !computeHash(data, hash)) return false;
+
+    auto it = m_entries.find(hash);
+    if (it != m_entries.end()) {
+        it->second.refs++;
+        m_dirty = true;
+        return true;
+    }
+
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = m_slotCount++;
+    }
+
+    _fseeki64(m_pack, (long long)slot * BLOCK_SIZE, SEEK_SET);
+    if (fwrite(data, 1, BLOCK_SIZE, m_pack) != BLOCK_SIZE) {
+        m_freeSlots.push_back(slot);
+        return false;
+    }
+
+    m_entries[hash] = { slot, 1 };
+    m_dirty = true;
+    return true;
+}
+
+bool BlockStore::get(const Hash& hash, uint8_t* out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ensureOpen()) return false;
+
+    auto it = m_entries.find(hash);
+    if (it == m_entries.end()) return false;
+
+    _fseeki64(m_pack, (long long)it->second.slot * BLOCK_SIZE, SEEK_SET);
+    return fread(out, 1, BLOCK_SIZE, m_pack) == BLOCK_SIZE;
+}
+
+void BlockStore::addRef(const Hash& hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ensureOpen()) return;
+
+    auto it = m_entries.find(hash);
+    if (it != m_entries.end()) {
+        it->second.refs++;
+        m_dirty = true;
+    }
+}
+
+void BlockStore::release(const Hash& hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ensureOpen()) return;
+
+    auto it = m_entries.find(hash);
+    if (it == m_entries.end()) return;
+
+    if (--it->second.refs == 0) {
+        m_freeSlots.push_back(it->second.slot);
+        m_entries.erase(it);
+    }
+    m_dirty = true;
+}
+
+bool BlockStore::save() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pack) return false;
+    if (!m_dirty) return true;
+
+    // Block data must be on disk before an index that refers to it
+    if (!syncFile(m_pack)) return false;
+
+    BlockIndexHeader header = {};
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = VERSION;
+    header.blockSize = BLOCK_SIZE;
+    header.slotCount = m_slotCount;
+    header.entryCount = (uint32_t)m_entries.size();
+
+    std::vector<BlockIndexEntry> entries;
+    entries.reserve(m_entries.size());
+    for (const auto& e : m_entries) {
+        entries.push_back({ e.first, e.second.slot, e.second.refs });
+    }
+
+    if (!replaceFile(m_dir + "\\blocks.idx", &header, sizeof(header),
+                     entries.data(), entries.size() * sizeof(BlockIndexEntry))) {
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+size_t BlockStore::blockCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ensureOpen();
+    return m_entries.size();
+}
+
+bool BlockStore::isImage(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[sizeof(IMAGE_MAGIC)] = {};
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+    return got == sizeof(magic) && memcmp(magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0;
+}
+
+bool BlockStore::readImage(const std::string& path, ImageHeader& header, std::vector<Hash>& hashes) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0 &&
+              header.version == VERSION && header.blockSize == BLOCK_SIZE &&
+              header.blockCount == (header.imageSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (ok) {
+        hashes.resize(header.blockCount);
+        ok = hashes.empty() || fread(hashes.data(), sizeof(Hash), hashes.size(), f) == hashes.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+bool BlockStore::writeImage(const std::string& path, const ImageHeader& header, const std::vector<Hash>& hashes) {
+    // Replace atomically so a crash leaves either the old or new hash list
+    return replaceFile(path, &header, sizeof(header), hashes.data(), hashes.size() * sizeof(Hash));
+}
+
+bool BlockStore::importRaw(const std::string& rawPath, const std::string& imagePath,
+                           std::function<void(size_t done, size_t total)> progress) {
+    FILE* in = fopen(rawPath.c_str(), "rb");
+    if (!in) return false;
+
+    _fseeki64(in, 0, SEEK_END);
+    uint64_t imageSize = (uint64_t)_ftelli64(in);
+    _fseeki64(in, 0, SEEK_SET);
+
+    ImageHeader header = {};
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = VERSION;
+    header.blockSize = BLOCK_SIZE;
+    header.imageSize = imageSize;
+    header.blockCount = (uint32_t)((imageSize + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    BlockStore& store = instance();
+    std::vector<Hash> hashes;
+    hashes.reserve(header.blockCount);
+
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    bool ok = true;
+    for (uint32_t i = 0; i < header.blockCount && ok; i++) {
+        std::fill(block.begin(), block.end(), 0);
+        size_t want = (size_t)std::min<uint64_t>(BLOCK_SIZE, imageSize - (uint64_t)i * BLOCK_SIZE);
+        Hash hash;
+        ok = fread(block.data(), 1, want, in) == want && store.put(block.data(), hash);
+        if (ok) hashes.push_back(hash);
+        if (progress) progress((size_t)i * BLOCK_SIZE + want, (size_t)imageSize);
+    }
+    fclose(in);
+
+    ok = ok && store.save() && writeImage(imagePath, header, hashes);
+    if (!ok) {
+        for (const auto& hash : hashes) {
+            store.release(hash);
+        }
+        store.save();
+    }
+    return ok;
+}
+
+bool BlockStore::cloneImage(const std::string& sourcePath, const std::string& targetPath) {
+    ImageHeader header;
+    std::vector<Hash> hashes;
+    if (!readImage(sourcePath, header, hashes)) return false;
+
+    BlockStore& store = instance();
+    for (const auto& hash : hashes) {
+        store.addRef(hash);
+    }
+
+    if (store.save() && writeImage(targetPath, header, hashes)) {
+        return true;
+    }
+
+    for (const auto& hash : hashes) {
+        store.release(hash);
+    }
+    store.save();
+    return false;
+}
+
+bool BlockStore::deleteImage(const std::string& path) {
+    ImageHeader header;
+    std::vector<Hash> hashes;
+    if (!readImage(path, header, hashes)) return false;
+
+    // Drop the image first; if that fails its blocks are still referenced
+    if (!DeleteFileA(path.c_str())) return false;
+
+    BlockStore& store = instance();
+    for (const auto& hash : hashes) {
+        store.release(hash);
+    }
+    return store.save();
+}
+
+// ---------------------------------------------------------------------------
+// DedupDiskStore
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<DedupDiskStore> DedupDiskStore::open(const std::string& path, bool writable) {
+    std::unique_ptr<DedupDiskStore> store(new DedupDiskStore());
+    if (!BlockStore::readImage(path, store->m_header, store->m_hashes)) {
+        return nullptr;
+    }
+    store->m_path = path;
+    store->m_writable = writable;
+    store->m_block.resize(BlockStore::BLOCK_SIZE);
+    return store;
+}
+
+DedupDiskStore::~DedupDiskStore() {
+    flush();
+}
+
+bool DedupDiskStore::loadBlock(uint32_t index) {
+    if (m_cachedIndex == (int64_t)index) return true;
+    if (!commitBlock()) return false;
+
+    if (!BlockStore::instance().get(m_hashes[index], m_block.data())) {
+        m_cachedIndex = -1;
+        return false;
+    }
+    m_cachedIndex = index;
+    return true;
+}
+
+bool DedupDiskStore::commitBlock() {
+    if (!m_blockDirty) return true;
+
+    BlockStore::Hash hash;
+    if (!BlockStore::instance().put(m_block.data(), hash)) return false;
+
+    // The old block stays referenced until the new hash list is on disk
+    BlockStore::Hash& slot = m_hashes[(size_t)m_cachedIndex];
+    m_pendingRelease.push_back(slot);
+    slot = hash;
+    m_blockDirty = false;
+    m_dirty = true;
+    return true;
+}
+
+size_t DedupDiskStore::read(size_t offset, uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint32_t index = (uint32_t)(pos / BlockStore::BLOCK_SIZE);
+        size_t within = pos % BlockStore::BLOCK_SIZE;
+        size_t chunk = std::min(count - done, (size_t)BlockStore::BLOCK_SIZE - within);
+
+        if (!loadBlock(index)) break;
+        memcpy(buffer + done, m_block.data() + within, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+size_t DedupDiskStore::write(size_t offset, const uint8_t* buffer, size_t count) {
+    if (!m_writable) return 0;
+
+    // Fixed geometry, as for containers
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint32_t index = (uint32_t)(pos / BlockStore::BLOCK_SIZE);
+        size_t within = pos % BlockStore::BLOCK_SIZE;
+        size_t chunk = std::min(count - done, (size_t)BlockStore::BLOCK_SIZE - within);
+
+        if (!loadBlock(index)) break;
+        memcpy(m_block.data() + within, buffer + done, chunk);
+        m_blockDirty = true;
+        done += chunk;
+    }
+    return done;
+}
+
+void DedupDiskStore::sync() {
+    // Every save of the pack, index and hash list is already durable
+    flush();
+}
+
+void DedupDiskStore::flush() {
+    if (!m_writable) return;
+    commitBlock();
+    if (!m_dirty) return;
+
+    // New references first, then the image, then drop the old references
+    BlockStore& store = BlockStore::instance();
+    if (!store.save() || !BlockStore::writeImage(m_path, m_header, m_hashes)) {
+        return;
+    }
+    for (const auto& hash : m_pendingRelease) {
+        store.release(hash);
+    }
+    m_pendingRelease.clear();
+    store.save();
+    m_dirty = false;
+}
@@ -0,0 +1,158 @@
+/*
+ * BlockStore.h - Content-Addressed Deduplicated Disk Storage
+ *
+ * Catalog disks, their edited copies and per-project variants are mostly
+ * identical. A deduplicated image (.imgref) stores no sector data of its own:
+ * it is a list of SHA-256 block hashes into a shared, refcounted block store
+ * under getUserDataDirectory()\blocks. Identical 4K blocks across all images
+ * are stored once, and cloning an image only copies its hash list.
+ *
+ * Store layout:
+ *   blocks.pack   fixed 4K slots, reused once their refcount drops to zero
+ *   blocks.idx    BlockIndexHeader + BlockIndexEntry[entryCount]
+ *
+ * Image layout:
+ *   ImageHeader + hash[blockCount]
+ *
+ * References are taken before an image is written and dropped only after it
+ * is on disk, so an interrupted update can leak blocks but never frees one
+ * that an image still points at.
+ */
+
+#pragma once
+
+#include "DiskStore.h"
+#include <array>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class BlockStore {
+public:
+    static constexpr uint32_t BLOCK_SIZE = 4096;  // 8 HBIOS sectors
+
+    using Hash = std::array<uint8_t, 32>;
+
+    static constexpr char INDEX_MAGIC[8] = { 'Z', '8', '0', 'B', 'L', 'K', 'I', 'X' };
+    static constexpr char IMAGE_MAGIC[8] = { 'Z', '8', '0', 'I', 'M', 'R', 'E', 'F' };
+    static constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+    struct BlockIndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t blockSize;
+        uint32_t slotCount;     // Slots allocated in blocks.pack
+        uint32_t entryCount;
+    };
+
+    struct BlockIndexEntry {
+        Hash hash;
+        uint32_t slot;
+        uint32_t refs;
+    };
+
+    struct ImageHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t blockSize;
+        uint64_t imageSize;
+        uint32_t blockCount;
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    static BlockStore& instance();
+
+    // Store a block (or take another reference to an identical one)
+    bool put(const uint8_t* data, Hash& hash);
+    bool get(const Hash& hash, uint8_t* out);
+    void addRef(const Hash& hash);
+    void release(const Hash& hash);
+
+    // Persist refcounts and slot assignments; pack and index are both on
+    // stable storage when it returns true
+    bool save();
+
+    // Unique blocks currently held
+    size_t blockCount();
+
+    // Deduplicated image files
+    static bool isImage(const std::string& path);
+    static bool importRaw(const std::string& rawPath, const std::string& imagePath,
+                          std::function<void(size_t done, size_t total)> progress = nullptr);
+    static bool cloneImage(const std::string& sourcePath, const std::string& targetPath);
+    static bool deleteImage(const std::string& path);
+
+    // Load/save an image's hash list
+    static bool readImage(const std::string& path, ImageHeader& header, std::vector<Hash>& hashes);
+    static bool writeImage(const std::string& path, const ImageHeader& header, const std::vector<Hash>& hashes);
+
+private:
+    BlockStore() = default;
+    ~BlockStore();
+    BlockStore(const BlockStore&) = delete;
+    BlockStore& operator=(const BlockStore&) = delete;
+
+    struct HashKey {
+        size_t operator()(const Hash& h) const {
+            size_t v;
+            memcpy(&v, h.data(), sizeof(v));  // Already uniformly distributed
+            return v;
+        }
+    };
+
+    struct Entry {
+        uint32_t slot;
+        uint32_t refs;
+    };
+
+    bool ensureOpen();
+    bool computeHash(const uint8_t* data, Hash& hash);
+
+    std::mutex m_mutex;
+    bool m_opened = false;
+    std::string m_dir;
+    FILE* m_pack = nullptr;
+    uint32_t m_slotCount = 0;
+    std::vector<uint32_t> m_freeSlots;
+    std::unordered_map<Hash, Entry, HashKey> m_entries;
+    bool m_dirty = false;
+
+    void* m_algorithm = nullptr;  // BCRYPT_ALG_HANDLE
+};
+
+// DiskStore over a deduplicated image. Writes are copy-on-write: the changed
+// block is stored under its new hash and the old one released on flush.
+class DedupDiskStore : public DiskStore {
+public:
+    static std::unique_ptr<DedupDiskStore> open(const std::string& path, bool writable);
+    ~DedupDiskStore() override;
+
+    size_t read(size_t offset, uint8_t* buffer, size_t count) override;
+    size_t write(size_t offset, const uint8_t* buffer, size_t count) override;
+    void flush() override;
+    void sync() override;
+    size_t size() const override { return (size_t)m_header.imageSize; }
+
+private:
+    DedupDiskStore() = default;
+
+    bool loadBlock(uint32_t index);
+    bool commitBlock();
+
+    std::string m_path;
+    bool m_writable = false;
+    BlockStore::ImageHeader m_header = {};
+    std::vector<BlockStore::Hash> m_hashes;
+    std::vector<BlockStore::Hash> m_pendingRelease;  // Replaced since last flush
+    bool m_dirty = false;
+
+    // Last block touched, so sector-at-a-time I/O doesn't refetch or rehash
+    // it; a modified block is stored when I/O moves on or on flush
+    int64_t m_cachedIndex = -1;
+    bool m_blockDirty = false;
+    std::vector<uint8_t> m_block;
+};
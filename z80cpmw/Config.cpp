@@ -51,14 +51,20 @@ void to_json(json& j, const AppConfig& c) {
             {"rom", c.rom},
             {"debug", c.debug},
             {"bootString", c.bootString},
-            {"warnManifestWrites", c.warnManifestWrites}
+            {"warnManifestWrites", c.warnManifestWrites},
+            {"journalDiskWrites", c.journalDiskWrites},
+            {"recordInput", c.recordInput}
         }},
         {"display", {
             {"fontSize", c.fontSize},
-            {"fontName", c.fontName}
+            {"fontName", c.fontName},
+            {"scrollbackLines", c.scrollbackLines},
+            {"rows", c.terminalRows},
+            {"cols", c.terminalCols}
         }},
         {"hardware", {
-            {"dazzler", c.dazzlers}
+            {"dazzler", c.dazzlers},
+            {"captureDedupe", c.dazzlerCaptureDedupe}
         }}
     };
 
@@ -84,6 +90,8 @@ void from_json(const json& j, AppConfig& c) {
         c.debug = core.value("debug", false);
         c.bootString = core.value("bootString", "");
         c.warnManifestWrites = core.value("warnManifestWrites", true);
+        c.journalDiskWrites = core.value("journalDiskWrites", false);
+        c.recordInput = core.value("recordInput", false);
     }
 
     // Display settings
@@ -91,6 +99,9 @@ void from_json(const json& j, AppConfig& c) {
         const auto& display = j["display"];
         c.fontSize = display.value("fontSize", 20);
         c.fontName = display.value("fontName", "Consolas");
+        c.scrollbackLines = display.value("scrollbackLines", 10000);
+        c.terminalRows = display.value("rows", 25);
+        c.terminalCols = display.value("cols", 80);
     }
 
     // Disks
@@ -111,6 +122,7 @@ void from_json(const json& j, AppConfig& c) {
         if (hw.contains("dazzler") && hw["dazzler"].is_array()) {
             c.dazzlers = hw["dazzler"].get<std::vector<DazzlerConfig>>();
         }
+        c.dazzlerCaptureDedupe = hw.value("captureDedupe", true);
     }
 }
 
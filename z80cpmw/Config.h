@@ -39,16 +39,22 @@ struct AppConfig {
     bool debug = false;
     std::string bootString;
     bool warnManifestWrites = true;  // Warn when writing to downloaded catalog disks
+    bool journalDiskWrites = false;  // Crash-safe disk writes via <image>.wal
+    bool recordInput = false;        // Session recordings include keyboard input
 
     // Display settings
     int fontSize = 20;
     std::string fontName = "Consolas";
+    int scrollbackLines = 10000;     // Terminal history above the screen (0 = none)
+    int terminalRows = 25;           // Terminal geometry, up to 60 rows
+    int terminalCols = 80;           // and 132 columns
 
     // Disk units (0-3)
     std::optional<DiskConfig> disks[4];
 
     // Hardware peripherals
     std::vector<DazzlerConfig> dazzlers;
+    bool dazzlerCaptureDedupe = true;  // Capture skips frames identical to the last
 };
 
 // Singleton configuration manager
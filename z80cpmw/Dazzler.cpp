@@ -1,19 +1,44 @@
 /*
  * Dazzler.cpp - Cromemco Dazzler Graphics Card Emulation Implementation
+ *
+ * Built without the precompiled header so it stays free of Windows headers.
  */
 
-#include "pch.h"
 #include "Dazzler.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DAZZLER_SSE2 1
+#endif
 
 Dazzler::Dazzler(uint8_t basePort)
     : m_basePort(basePort)
-    , m_startTime(std::chrono::steady_clock::now())
+    , m_canvas((size_t)MAX_WIDTH * MAX_HEIGHT, 0xFF000000)
 {
+    for (DazzlerFrame& frame : m_frames) {
+        frame.pixels.reserve((size_t)MAX_WIDTH * MAX_HEIGHT);
+    }
 }
 
 Dazzler::~Dazzler() {
 }
 
+void Dazzler::setClock(DazzlerClockCallback cb, uint64_t clockHz) {
+    m_clock = cb;
+    m_frameTicks = clockHz / 60;
+    m_lineTicks = m_frameTicks / 262;
+    m_vblankTicks = clockHz / 250;
+}
+
+void Dazzler::setFrameCallback(DazzlerFrameCallback cb) {
+    m_frameCallback = cb;
+    if (m_frameCallback) {
+        markAllDirty();
+    }
+}
+
 void Dazzler::portOut(uint8_t port, uint8_t value) {
     uint8_t portOffset = port - m_basePort;
 
@@ -22,14 +47,16 @@ void Dazzler::portOut(uint8_t port, uint8_t value) {
         // D7: Enable (1=on, 0=off)
         // D6-D0: Address bits A15-A9 (left shift 1 to get high byte of buffer addr)
         bool wasEnabled = m_enabled;
+        uint16_t oldAddr = m_framebufferAddr;
         m_enabled = (value & 0x80) != 0;
 
         // Calculate framebuffer address: bits 6-0 become A15-A9
         // The address is on a 512-byte boundary (A8-A0 = 0)
         m_framebufferAddr = ((uint16_t)(value & 0x7F)) << 9;
 
-        if (m_enabled != wasEnabled || m_enabled) {
-            triggerUpdate();
+        // Rewriting the same value (common in display loops) changes nothing
+        if (m_enabled != wasEnabled || (m_enabled && m_framebufferAddr != oldAddr)) {
+            markAllDirty();
         }
     }
     else if (portOffset == 1) {
@@ -42,14 +69,20 @@ void Dazzler::portOut(uint8_t port, uint8_t value) {
         // D2: Blue enable
         // D1: Green enable
         // D0: Red enable
+        bool changed = m_x4Mode != ((value & 0x40) != 0) ||
+                       m_use2K != ((value & 0x20) != 0) ||
+                       m_colorMode != ((value & 0x10) != 0) ||
+                       m_highIntensity != ((value & 0x08) != 0) ||
+                       m_colorMask != (value & 0x07);
+
         m_x4Mode = (value & 0x40) != 0;
         m_use2K = (value & 0x20) != 0;
         m_colorMode = (value & 0x10) != 0;
         m_highIntensity = (value & 0x08) != 0;
         m_colorMask = value & 0x07;
 
-        if (m_enabled) {
-            triggerUpdate();
+        if (changed && m_enabled) {
+            markAllDirty();
         }
     }
 }
@@ -61,37 +94,24 @@ uint8_t Dazzler::portIn(uint8_t port) {
         // Port 0xE (Status)
         // D7: Odd/Even line (low during odd lines, high during even)
         // D6: End of frame (low for 4ms between frames)
-
-        // Calculate timing based on NTSC timing
-        // Frame rate: ~60 Hz (16.67ms per frame)
-        // End of frame signal: low for 4ms between frames
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-            now - m_startTime).count();
-
-        // Frame timing (in microseconds)
-        const int64_t FRAME_TIME_US = 16667;  // ~60 Hz
-        const int64_t VBLANK_TIME_US = 4000;  // 4ms vertical blank
-        const int64_t LINE_TIME_US = 63;      // ~63.5us per line (262.5 lines/frame)
-
-        int64_t framePos = elapsed % FRAME_TIME_US;
+        //
+        // Derived from the emulated clock against a 60 Hz, 262-line NTSC
+        // raster, so polling loops see the same timing at any host speed
+        // (only as exact as the clock; the engine's clock counts
+        // instructions, so frame and line lengths are approximate)
+        uint64_t framePos = m_clock ? m_clock() % m_frameTicks : 0;
 
         uint8_t status = 0;
 
-        // D6: End of frame (low for 4ms at end of frame)
-        if (framePos >= (FRAME_TIME_US - VBLANK_TIME_US)) {
-            // In vertical blank - D6 is low
-            status &= ~0x40;
-        } else {
+        // D6: End of frame (low for the last 4ms of the frame)
+        if (framePos < m_frameTicks - m_vblankTicks) {
             status |= 0x40;
         }
 
         // D7: Odd/Even line
-        int64_t linePos = framePos / LINE_TIME_US;
-        if (linePos & 1) {
+        if ((framePos / m_lineTicks) & 1) {
             status |= 0x80;  // Even line (high)
         }
-        // Odd line: D7 stays low
 
         return status;
     }
@@ -103,11 +123,62 @@ void Dazzler::onMemoryWrite(uint16_t addr, uint8_t value) {
     if (!m_enabled) return;
     if (!m_memory && !m_memoryReadCallback) return;
 
-    // Check if write is within framebuffer region
-    uint16_t bufferEnd = m_framebufferAddr + getMemorySize();
-    if (addr >= m_framebufferAddr && addr < bufferEnd) {
-        triggerUpdate();
+    // Check if write is within framebuffer region (offset wraps like the address)
+    uint16_t offset = (uint16_t)(addr - m_framebufferAddr);
+    if (offset >= getMemorySize()) return;
+
+    int row = offset >> 4;
+    m_dirty.rows[row >> 6] |= 1ull << (row & 63);
+}
+
+void Dazzler::markAllDirty() {
+    m_dirty.all = true;
+}
+
+void Dazzler::endFrame() {
+    // One display update per frame, however many stores the guest made
+    m_frameCount++;
+    if (!m_dirty.any()) return;
+    publishFrame();
+    triggerUpdate();
+}
+
+void Dazzler::publishFrame() {
+    int width = getWidth();
+    int height = getHeight();
+    size_t count = (size_t)width * height;
+
+    // Only the marked rows are re-expanded; the canvas keeps the rest
+    if (m_enabled && (m_memory || m_memoryReadCallback || m_memoryBlockReadCallback)) {
+        snapshotPicture();
+        expandPicture(m_canvas.data(), false, &m_dirty);
     }
+    m_dirty = DazzlerDirtyRegion();
+
+    DazzlerFrame& back = m_frames[m_backIndex];
+    back.enabled = m_enabled;
+    back.width = width;
+    back.height = height;
+    back.sequence = ++m_frameSequence;
+    back.frameNumber = m_frameCount;
+    back.pixels.assign(m_canvas.begin(), m_canvas.begin() + count);
+
+    if (m_frameCallback) {
+        m_frameCallback(back);
+    }
+
+    // Release the filled frame; whatever the display left in the middle
+    // (stale or never taken) becomes the next back frame
+    int previous = m_middle.exchange(m_backIndex | FRAME_FRESH, std::memory_order_acq_rel);
+    m_backIndex = previous & ~FRAME_FRESH;
+}
+
+const DazzlerFrame& Dazzler::acquireFrame() {
+    if (m_middle.load(std::memory_order_relaxed) & FRAME_FRESH) {
+        int previous = m_middle.exchange(m_frontIndex, std::memory_order_acq_rel);
+        m_frontIndex = previous & ~FRAME_FRESH;
+    }
+    return m_frames[m_frontIndex];
 }
 
 // Helper to read memory using callback or raw pointer
@@ -138,21 +209,132 @@ int Dazzler::getHeight() const {
 
 void Dazzler::render(uint8_t* rgbaBuffer) {
     if (!rgbaBuffer) return;
-    if (!m_memory && !m_memoryReadCallback) return;
+    if (!m_memory && !m_memoryReadCallback && !m_memoryBlockReadCallback) return;
 
-    int width = getWidth();
-    int height = getHeight();
+    size_t count = (size_t)getWidth() * getHeight();
+    m_renderScratch.resize(count);
+    snapshotPicture();
+    expandPicture(m_renderScratch.data(), true, nullptr);
+    memcpy(rgbaBuffer, m_renderScratch.data(), count * 4);
+}
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            uint32_t color = getPixelColor(x, y);
+void Dazzler::renderPixels(uint32_t* pixels, const DazzlerDirtyRegion* region) {
+    if (!pixels) return;
+    if (!m_memory && !m_memoryReadCallback && !m_memoryBlockReadCallback) return;
 
-            int idx = (y * width + x) * 4;
-            rgbaBuffer[idx + 0] = (color >> 16) & 0xFF;  // R
-            rgbaBuffer[idx + 1] = (color >> 8) & 0xFF;   // G
-            rgbaBuffer[idx + 2] = color & 0xFF;          // B
-            rgbaBuffer[idx + 3] = 0xFF;                  // A
+    snapshotPicture();
+    expandPicture(pixels, false, region);
+}
+
+void Dazzler::snapshotPicture() {
+    int size = getMemorySize();
+
+    if (m_memoryBlockReadCallback) {
+        // Picture memory wraps at the top of the address space
+        size_t first = std::min<size_t>(size, 0x10000 - m_framebufferAddr);
+        m_memoryBlockReadCallback(m_framebufferAddr, m_picture, first);
+        if (first < (size_t)size) {
+            m_memoryBlockReadCallback(0, m_picture + first, size - first);
+        }
+        return;
+    }
+    for (int i = 0; i < size; i++) {
+        m_picture[i] = readMemory((uint16_t)(m_framebufferAddr + i));
+    }
+}
+
+// Byte order of a table entry: 0xAARRGGBB, or R,G,B,A in memory
+static inline uint32_t pixelValue(uint32_t argb, bool rgbaOrder) {
+    if (!rgbaOrder) return argb;
+    return (argb & 0xFF00FF00) | ((argb >> 16) & 0xFF) | ((argb & 0xFF) << 16);
+}
+
+void Dazzler::updateLookupTables(bool rgbaOrder) {
+    int order = rgbaOrder ? 1 : 0;
+
+    // Normal mode: the palette depends only on color vs B&W
+    int nibbleKey = (m_colorMode ? 2 : 0) | order;
+    if (nibbleKey != m_nibbleLutKey) {
+        uint32_t palette[16];
+        for (int c = 0; c < 16; c++) {
+            palette[c] = pixelValue(colorToRGBA((uint8_t)c), rgbaOrder);
+        }
+        for (int b = 0; b < 256; b++) {
+            m_nibbleLut[b][0] = palette[b & 0x0F];
+            m_nibbleLut[b][1] = palette[b >> 4];
         }
+        m_nibbleLutKey = nibbleKey;
+    }
+
+    // X4 mode: one foreground color from the format register
+    uint8_t onColor = m_colorMask | (m_highIntensity ? 0x08 : 0);
+    int x4Key = (onColor << 2) | (m_colorMode ? 2 : 0) | order;
+    if (x4Key != m_x4LutKey) {
+        uint32_t on = pixelValue(colorToRGBA(onColor), rgbaOrder);
+        uint32_t off = pixelValue(0xFF000000, rgbaOrder);
+
+        // Bits by position in the block:  D0 D1 D4 D5 / D2 D3 D6 D7
+        static const int BIT_AT[8] = { 0, 1, 4, 5, 2, 3, 6, 7 };
+        for (int b = 0; b < 256; b++) {
+            for (int i = 0; i < 8; i++) {
+                m_x4Lut[b][i] = ((b >> BIT_AT[i]) & 1) ? on : off;
+            }
+        }
+        m_x4LutKey = x4Key;
+    }
+}
+
+void Dazzler::expandPicture(uint32_t* pixels, bool rgbaOrder, const DazzlerDirtyRegion* region) {
+    updateLookupTables(rgbaOrder);
+
+    // Picture memory is rows of 16 bytes; 2K modes are four 512-byte
+    // quadrants, each laid out like a 512-byte picture
+    int width = getWidth();
+    int half = width / 2;
+    int rows = getMemorySize() / 16;
+    for (int r = 0; r < rows; r++) {
+        if (region && !region->row(r)) continue;
+
+        int quadrant = r >> 5;
+        int quadrantRow = r & 31;
+        uint32_t* origin = pixels;
+        if (m_use2K) {
+            origin += (size_t)(quadrant / 2) * half * width + (quadrant % 2) * half;
+        }
+
+        const uint8_t* src = m_picture + r * 16;
+        if (m_x4Mode) {
+            uint32_t* top = origin + (size_t)quadrantRow * 2 * width;
+            expandX4Row(src, top, top + width);
+        } else {
+            expandNibbleRow(src, origin + (size_t)quadrantRow * width);
+        }
+    }
+}
+
+void Dazzler::expandNibbleRow(const uint8_t* src, uint32_t* dst) {
+    // 16 bytes, two pixels per byte
+    for (int x = 0; x < 16; x++) {
+#ifdef DAZZLER_SSE2
+        _mm_storel_epi64((__m128i*)(dst + x * 2), _mm_loadl_epi64((const __m128i*)m_nibbleLut[src[x]]));
+#else
+        dst[x * 2] = m_nibbleLut[src[x]][0];
+        dst[x * 2 + 1] = m_nibbleLut[src[x]][1];
+#endif
+    }
+}
+
+void Dazzler::expandX4Row(const uint8_t* src, uint32_t* top, uint32_t* bottom) {
+    // 16 bytes, each a 4x2 block
+    for (int x = 0; x < 16; x++) {
+        const uint32_t* block = m_x4Lut[src[x]];
+#ifdef DAZZLER_SSE2
+        _mm_storeu_si128((__m128i*)(top + x * 4), _mm_load_si128((const __m128i*)block));
+        _mm_storeu_si128((__m128i*)(bottom + x * 4), _mm_load_si128((const __m128i*)(block + 4)));
+#else
+        memcpy(top + x * 4, block, 4 * sizeof(uint32_t));
+        memcpy(bottom + x * 4, block + 4, 4 * sizeof(uint32_t));
+#endif
     }
 }
 
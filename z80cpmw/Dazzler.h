@@ -3,13 +3,29 @@
  *
  * Emulates the Cromemco Dazzler color graphics card (1976).
  * Supports both normal resolution (32x32/64x64) and X4 resolution (64x64/128x128) modes.
+ *
+ * Rendering copies the picture memory once per frame and expands each byte
+ * through a lookup table (two pixels per byte in normal mode, a 4x2 block in
+ * X4 mode), so a frame costs a block copy plus one table copy per byte.
+ *
+ * Guest stores into picture memory only mark the 16-byte row they hit; the
+ * engine calls endFrame() once per emulated 60 Hz frame on the emulator
+ * thread, and only then is a changed picture re-expanded (just the marked
+ * rows) and published.
+ *
+ * Frames reach the display through a lock-free triple buffer: the emulator
+ * fills the back frame and swaps it with the middle one, the display swaps
+ * the middle one with its front frame when a newer one is waiting. Neither
+ * side ever waits for the other, the display only sees complete frames, and
+ * guest memory is only read on the emulator thread.
  */
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
-#include <chrono>
+#include <vector>
 
 // Callback when display needs updating
 using DazzlerUpdateCallback = std::function<void()>;
@@ -17,6 +33,36 @@ using DazzlerUpdateCallback = std::function<void()>;
 // Callback to read memory (handles banked memory correctly)
 using DazzlerMemoryReadCallback = std::function<uint8_t(uint16_t addr)>;
 
+// Callback to copy a block of memory; one call per frame instead of per byte
+using DazzlerMemoryBlockReadCallback = std::function<void(uint16_t addr, uint8_t* dest, size_t count)>;
+
+// Callback returning the emulated clock in ticks of the rate passed to setClock
+using DazzlerClockCallback = std::function<uint64_t()>;
+
+struct DazzlerFrame;
+
+// Callback with each published frame, on the emulator thread
+using DazzlerFrameCallback = std::function<void(const DazzlerFrame& frame)>;
+
+// Picture memory rows (16 bytes each) changed since the display last looked
+struct DazzlerDirtyRegion {
+    uint64_t rows[2] = {};      // Bit per row; 2K = 128 rows
+    bool all = false;           // Mode, address or enable changed
+
+    bool row(int r) const { return all || ((rows[r >> 6] >> (r & 63)) & 1); }
+    bool any() const { return all || rows[0] || rows[1]; }
+};
+
+// A completed picture as handed to the display
+struct DazzlerFrame {
+    bool enabled = false;
+    int width = 0;
+    int height = 0;
+    uint64_t sequence = 0;          // Counts published frames
+    uint64_t frameNumber = 0;       // Emulated 60 Hz frame it completed on
+    std::vector<uint32_t> pixels;   // 0xAARRGGBB, top-down, width * height
+};
+
 class Dazzler {
 public:
     // Display modes
@@ -41,12 +87,33 @@ public:
     // Memory access - call when Z80 writes to memory
     void onMemoryWrite(uint16_t addr, uint8_t value);
 
+    // Emulated frame boundary (emulator thread): if the picture changed
+    // during the frame, publish it and raise the update callback, so updates
+    // never outpace 60 Hz
+    void endFrame();
+
+    // Display thread: the most recent published frame. Stays valid and
+    // unchanged until the next call.
+    const DazzlerFrame& acquireFrame();
+
     // Set memory pointer for reading framebuffer (deprecated - use setMemoryReadCallback)
     void setMemoryPointer(const uint8_t* memory) { m_memory = memory; }
 
     // Set memory read callback for proper banked memory access
     void setMemoryReadCallback(DazzlerMemoryReadCallback cb) { m_memoryReadCallback = cb; }
 
+    // Set block read callback (preferred for rendering)
+    void setMemoryBlockReadCallback(DazzlerMemoryBlockReadCallback cb) { m_memoryBlockReadCallback = cb; }
+
+    // Emulated clock for the status port's raster timing (see portIn); the
+    // raster is only as accurate as the clock, which may be approximate
+    void setClock(DazzlerClockCallback cb, uint64_t clockHz);
+
+    // Also hand every published frame to cb (e.g. DazzlerCapture::submit);
+    // the current picture goes out at the next frame boundary. Set it only
+    // while the emulator thread is not inside endFrame().
+    void setFrameCallback(DazzlerFrameCallback cb);
+
     // State queries
     bool isEnabled() const { return m_enabled; }
     uint8_t getBasePort() const { return m_basePort; }
@@ -61,11 +128,19 @@ public:
     bool isHighIntensity() const { return m_highIntensity; }
     uint8_t getColorMask() const { return m_colorMask; }  // RGB enable bits
 
+    // Direct rendering reads guest memory: emulator thread only (the
+    // display uses acquireFrame)
+
     // Render the current framebuffer to an RGBA buffer
     // Returns pixel data in RGBA format (4 bytes per pixel)
     // Buffer must be at least getWidth() * getHeight() * 4 bytes
     void render(uint8_t* rgbaBuffer);
 
+    // Render as 0xAARRGGBB per pixel, top-down (the 32-bit DIB layout)
+    // Buffer must hold at least getWidth() * getHeight() pixels. With a
+    // region, only its rows are redrawn over the previous frame's pixels.
+    void renderPixels(uint32_t* pixels, const DazzlerDirtyRegion* region = nullptr);
+
     // Get a single pixel color as RGBA
     uint32_t getPixelColor(int x, int y);
 
@@ -89,6 +164,24 @@ private:
     // Read memory (uses callback if set, otherwise raw pointer)
     uint8_t readMemory(uint16_t addr);
 
+    // Copy the current picture memory into m_picture
+    void snapshotPicture();
+
+    // Expand m_picture through the lookup tables; rgbaOrder selects R,G,B,A
+    // byte order instead of 0xAARRGGBB
+    void expandPicture(uint32_t* pixels, bool rgbaOrder, const DazzlerDirtyRegion* region);
+    void expandNibbleRow(const uint8_t* src, uint32_t* dst);
+    void expandX4Row(const uint8_t* src, uint32_t* top, uint32_t* bottom);
+
+    // Mark the whole picture changed
+    void markAllDirty();
+
+    // Bring m_canvas up to date and hand a copy to the display
+    void publishFrame();
+
+    // Rebuild the tables when the mode, color or byte order changed
+    void updateLookupTables(bool rgbaOrder);
+
     // Port configuration
     uint8_t m_basePort;
 
@@ -108,12 +201,46 @@ private:
 
     // Memory read callback (preferred)
     DazzlerMemoryReadCallback m_memoryReadCallback;
+    DazzlerMemoryBlockReadCallback m_memoryBlockReadCallback;
+
+    // Picture memory copied at the start of each render
+    uint8_t m_picture[MEM_2K] = {};
+
+    // Byte-to-pixels tables: normal mode gives the two pixels of a byte
+    // (low nibble first); X4 mode gives the 4x2 block of a byte, top row
+    // then bottom row. Keyed by the state they were built for.
+    alignas(16) uint32_t m_nibbleLut[256][2];
+    alignas(16) uint32_t m_x4Lut[256][8];
+    int m_nibbleLutKey = -1;
+    int m_x4LutKey = -1;
+    std::vector<uint32_t> m_renderScratch;
+
+    // Rows changed since the last published frame (emulator thread)
+    DazzlerDirtyRegion m_dirty = { {}, true };
+
+    // Current picture, updated a row at a time (emulator thread)
+    std::vector<uint32_t> m_canvas;
+
+    // Triple buffer: the emulator owns m_frames[m_backIndex], the display
+    // owns m_frames[m_frontIndex], and m_middle holds the third index plus
+    // FRAME_FRESH while it is newer than the front
+    static constexpr int FRAME_FRESH = 4;
+    DazzlerFrame m_frames[3];
+    int m_backIndex = 0;
+    int m_frontIndex = 1;
+    std::atomic<int> m_middle{2};
+    uint64_t m_frameSequence = 0;
+    uint64_t m_frameCount = 0;      // endFrame() calls
+    DazzlerFrameCallback m_frameCallback;
 
     // Display scaling
     int m_scale = 2;
 
-    // Timing for input port
-    std::chrono::steady_clock::time_point m_startTime;
+    // Raster model for the status port, in ticks of the emulated clock
+    DazzlerClockCallback m_clock;
+    uint64_t m_frameTicks = 4000000 / 60;
+    uint64_t m_lineTicks = m_frameTicks / 262;
+    uint64_t m_vblankTicks = 4000000 / 250;  // 4 ms
 
     // Update callback
     DazzlerUpdateCallback m_updateCallback;
@@ -0,0 +1,581 @@
+/*
+ * DazzlerCapture.cpp - Dazzler Frame Capture Implementation
+ *
+ * Built without the precompiled header so it stays free of Windows headers.
+ */
+
+#include "DazzlerCapture.h"
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================
+// Encoding helpers
+//=============================================================================
+
+namespace {
+
+// Little-endian bit packer shared by deflate and GIF LZW
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void put(uint32_t value, int count) {
+        m_bits |= value << m_count;
+        m_count += count;
+        while (m_count >= 8) {
+            m_out.push_back((uint8_t)m_bits);
+            m_bits >>= 8;
+            m_count -= 8;
+        }
+    }
+
+    // Huffman codes go out most significant bit first
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        }
+        put(reversed, length);
+    }
+
+    void flush() {
+        if (m_count > 0) {
+            m_out.push_back((uint8_t)m_bits);
+        }
+        m_bits = 0;
+        m_count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+    uint32_t m_bits = 0;
+    int m_count = 0;
+};
+
+uint32_t crc32(const uint8_t* data, size_t count, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < count; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t count) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < count; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+void putLiteral(BitWriter& bits, int symbol) {
+    // Fixed Huffman literal/length code (RFC 1951, 3.2.6)
+    if (symbol < 144)      bits.putCode(0x30 + symbol, 8);
+    else if (symbol < 256) bits.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) bits.putCode(symbol - 256, 7);
+    else                   bits.putCode(0xC0 + symbol - 280, 8);
+}
+
+void putMatch(BitWriter& bits, int length, int distance) {
+    static const uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const uint16_t DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static const uint8_t DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    int l = 28;
+    while (LENGTH_BASE[l] > length) l--;
+    putLiteral(bits, 257 + l);
+    bits.put(length - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+
+    int d = 29;
+    while (DIST_BASE[d] > distance) d--;
+    bits.putCode(d, 5);
+    bits.put(distance - DIST_BASE[d], DIST_EXTRA[d]);
+}
+
+// zlib stream: one fixed-Huffman deflate block with hash-chain LZ77
+// matching. Dazzler pictures are large flat areas, which this handles well.
+void zlibCompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out) {
+    constexpr int WINDOW = 32768;
+    constexpr int MIN_MATCH = 3;
+    constexpr int MAX_MATCH = 258;
+    constexpr int HASH_BITS = 14;
+    constexpr int MAX_CHAIN = 64;
+
+    out.push_back(0x78);
+    out.push_back(0x9C);
+
+    BitWriter bits(out);
+    bits.put(1, 1);     // BFINAL
+    bits.put(1, 2);     // Fixed Huffman
+
+    const int n = (int)data.size();
+    const uint8_t* d = data.data();
+    std::vector<int> head(1 << HASH_BITS, -1);
+    std::vector<int> prev(data.size(), -1);
+
+    auto hash = [d](int i) {
+        return ((d[i] << 10) ^ (d[i + 1] << 5) ^ d[i + 2]) & ((1 << HASH_BITS) - 1);
+    };
+    auto insert = [&](int i) {
+        if (i + MIN_MATCH > n) return;
+        int h = hash(i);
+        prev[i] = head[h];
+        head[h] = i;
+    };
+
+    int i = 0;
+    while (i < n) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (i + MIN_MATCH <= n) {
+            int limit = std::min(MAX_MATCH, n - i);
+            int chain = MAX_CHAIN;
+            for (int candidate = head[hash(i)]; candidate >= 0 && i - candidate <= WINDOW && chain-- > 0;
+                 candidate = prev[candidate]) {
+                int length = 0;
+                while (length < limit && d[candidate + length] == d[i + length]) length++;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                    if (length == limit) break;
+                }
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            putMatch(bits, bestLength, bestDistance);
+            for (int k = 0; k < bestLength; k++) insert(i + k);
+            i += bestLength;
+        } else {
+            putLiteral(bits, d[i]);
+            insert(i);
+            i++;
+        }
+    }
+    putLiteral(bits, 256);
+    bits.flush();
+
+    uint32_t adler = adler32(data.data(), data.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((uint8_t)(adler >> shift));
+    }
+}
+
+// Palette and per-pixel indices; a Dazzler frame has at most 16 colors,
+// anything past 256 (never seen) maps to entry 0
+void indexFrame(const DazzlerFrame& frame, std::vector<uint32_t>& palette, std::vector<uint8_t>& indices) {
+    size_t count = (size_t)frame.width * frame.height;
+    palette.clear();
+    indices.resize(count);
+
+    uint32_t lastColor = 0;
+    uint8_t lastIndex = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t color = frame.pixels[i] & 0x00FFFFFF;
+        if (i > 0 && color == lastColor) {
+            indices[i] = lastIndex;
+            continue;
+        }
+        size_t p = std::find(palette.begin(), palette.end(), color) - palette.begin();
+        if (p == palette.size()) {
+            if (palette.size() < 256) {
+                palette.push_back(color);
+            } else {
+                p = 0;
+            }
+        }
+        lastColor = color;
+        lastIndex = (uint8_t)p;
+        indices[i] = lastIndex;
+    }
+    if (palette.empty()) palette.push_back(0);
+}
+
+void putU32BE(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((uint8_t)(value >> shift));
+    }
+}
+
+void putU16LE(FILE* f, int value) {
+    fputc(value & 0xFF, f);
+    fputc((value >> 8) & 0xFF, f);
+}
+
+void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    putU32BE(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putU32BE(out, crc32(out.data() + start, out.size() - start));
+}
+
+// Emulated frames to GIF time units (1/100 s) at 60 Hz
+int64_t frameCentiseconds(uint64_t frameNumber) {
+    return (int64_t)(frameNumber * 100 / 60);
+}
+
+} // namespace
+
+//=============================================================================
+// PNG
+//=============================================================================
+
+bool DazzlerCapture::encodePng(const DazzlerFrame& frame, std::vector<uint8_t>& out) {
+    out.clear();
+    if (frame.width <= 0 || frame.height <= 0 ||
+        frame.pixels.size() < (size_t)frame.width * frame.height) {
+        return false;
+    }
+
+    std::vector<uint32_t> palette;
+    std::vector<uint8_t> indices;
+    indexFrame(frame, palette, indices);
+
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    out.insert(out.end(), SIGNATURE, SIGNATURE + 8);
+
+    std::vector<uint8_t> chunk;
+    putU32BE(chunk, (uint32_t)frame.width);
+    putU32BE(chunk, (uint32_t)frame.height);
+    chunk.push_back(8);     // Bit depth
+    chunk.push_back(3);     // Indexed color
+    chunk.push_back(0);     // Deflate
+    chunk.push_back(0);     // Adaptive filtering
+    chunk.push_back(0);     // No interlace
+    pngChunk(out, "IHDR", chunk);
+
+    chunk.clear();
+    for (uint32_t color : palette) {
+        chunk.push_back((uint8_t)(color >> 16));
+        chunk.push_back((uint8_t)(color >> 8));
+        chunk.push_back((uint8_t)color);
+    }
+    pngChunk(out, "PLTE", chunk);
+
+    // Filter type 0 on every row; indexed images compress best unfiltered
+    std::vector<uint8_t> raw;
+    raw.reserve(((size_t)frame.width + 1) * frame.height);
+    for (int y = 0; y < frame.height; y++) {
+        raw.push_back(0);
+        const uint8_t* row = indices.data() + (size_t)y * frame.width;
+        raw.insert(raw.end(), row, row + frame.width);
+    }
+    chunk.clear();
+    zlibCompress(raw, chunk);
+    pngChunk(out, "IDAT", chunk);
+
+    pngChunk(out, "IEND", std::vector<uint8_t>());
+    return true;
+}
+
+bool DazzlerCapture::writePng(const std::string& path, const DazzlerFrame& frame, std::string& error) {
+    std::vector<uint8_t> png;
+    if (!encodePng(frame, png)) {
+        error = "Empty frame";
+        return false;
+    }
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        error = "Cannot create " + path;
+        return false;
+    }
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        error = "Write failed: " + path;
+    }
+    return ok;
+}
+
+//=============================================================================
+// Capture
+//=============================================================================
+
+DazzlerCapture::~DazzlerCapture() {
+    stop();
+}
+
+bool DazzlerCapture::start(const std::string& path, Format format, bool dedupe, std::string& error) {
+    stop();
+
+    m_format = format;
+    m_dedupe = dedupe;
+    if (format == Format::Gif) {
+        m_gif = fopen(path.c_str(), "wb");
+        if (!m_gif) {
+            error = "Cannot create " + path;
+            return false;
+        }
+
+        // Header, logical screen without a global palette, loop forever
+        fwrite("GIF89a", 1, 6, m_gif);
+        putU16LE(m_gif, GIF_SIZE);
+        putU16LE(m_gif, GIF_SIZE);
+        static const uint8_t SCREEN[3] = { 0x00, 0x00, 0x00 };
+        fwrite(SCREEN, 1, sizeof(SCREEN), m_gif);
+        static const uint8_t LOOP[19] = {
+            0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+            0x03, 0x01, 0x00, 0x00, 0x00 };
+        fwrite(LOOP, 1, sizeof(LOOP), m_gif);
+    } else {
+        // "demo.png" -> demo_000123.png, ...
+        size_t slash = path.find_last_of("/\\");
+        size_t dot = path.find_last_of('.');
+        bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        m_stem = hasExtension ? path.substr(0, dot) : path;
+    }
+
+    m_queue.clear();
+    m_stopping = false;
+    m_written = 0;
+    m_dropped = 0;
+    m_error.clear();
+    m_hasLast = false;
+    m_hasPendingGif = false;
+    m_capturing = true;
+    m_worker = std::thread(&DazzlerCapture::workerThread, this);
+    return true;
+}
+
+void DazzlerCapture::stop() {
+    if (!m_capturing) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capturing = false;
+}
+
+void DazzlerCapture::submit(const DazzlerFrame& frame) {
+    // Only the copy happens here; the worker does everything else
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_capturing || m_stopping) return;
+    if (m_queue.size() >= MAX_QUEUED_FRAMES) {
+        m_dropped++;
+        return;
+    }
+    m_queue.push_back(frame);
+    m_wake.notify_one();
+}
+
+uint64_t DazzlerCapture::framesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+uint64_t DazzlerCapture::framesDropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+std::string DazzlerCapture::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void DazzlerCapture::setError(const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error.empty()) m_error = error;
+}
+
+void DazzlerCapture::workerThread() {
+    std::vector<DazzlerFrame> batch;
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            stopping = m_stopping;
+            std::swap(batch, m_queue);
+        }
+
+        for (DazzlerFrame& frame : batch) {
+            writeFrame(frame);
+        }
+        batch.clear();
+        if (stopping) break;
+    }
+
+    if (m_gif) {
+        finishGif();
+    }
+}
+
+void DazzlerCapture::writeFrame(DazzlerFrame& frame) {
+    size_t count = (size_t)frame.width * frame.height;
+    if (count == 0 || frame.pixels.size() < count) return;
+
+    // A disabled card shows nothing
+    if (!frame.enabled) {
+        std::fill(frame.pixels.begin(), frame.pixels.begin() + count, 0xFF000000);
+    }
+
+    if (m_dedupe && m_hasLast && frame.width == m_last.width && frame.height == m_last.height &&
+        memcmp(frame.pixels.data(), m_last.pixels.data(), count * sizeof(uint32_t)) == 0) {
+        return;
+    }
+    m_last = frame;
+    m_hasLast = true;
+
+    if (m_format == Format::PngSequence) {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "_%06llu.png", (unsigned long long)frame.frameNumber);
+        std::string error;
+        if (!writePng(m_stem + suffix, frame, error)) {
+            setError(error);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written++;
+        return;
+    }
+
+    // A GIF frame is written once the next one says how long it lasts
+    if (m_hasPendingGif) {
+        if (frameCentiseconds(frame.frameNumber) - frameCentiseconds(m_pendingGif.frameNumber) < GIF_MIN_DELAY) {
+            // Faster than viewers can show: the newer picture takes the slot
+            uint64_t start = m_pendingGif.frameNumber;
+            m_pendingGif = std::move(frame);
+            m_pendingGif.frameNumber = start;
+            return;
+        }
+        writeGifFrame(m_pendingGif, frame.frameNumber);
+    }
+    m_pendingGif = std::move(frame);
+    m_hasPendingGif = true;
+}
+
+void DazzlerCapture::writeGifFrame(const DazzlerFrame& frame, uint64_t endFrame) {
+    // Scale up to the logical screen so every mode fills the animation
+    int scale = std::max(1, GIF_SIZE / std::max(frame.width, frame.height));
+    DazzlerFrame scaled;
+    scaled.width = std::min(GIF_SIZE, frame.width * scale);
+    scaled.height = std::min(GIF_SIZE, frame.height * scale);
+    scaled.pixels.resize((size_t)scaled.width * scaled.height);
+    for (int y = 0; y < scaled.height; y++) {
+        const uint32_t* src = frame.pixels.data() + (size_t)(y / scale) * frame.width;
+        uint32_t* dst = scaled.pixels.data() + (size_t)y * scaled.width;
+        for (int x = 0; x < scaled.width; x++) {
+            dst[x] = src[x / scale];
+        }
+    }
+
+    std::vector<uint32_t> palette;
+    std::vector<uint8_t> indices;
+    indexFrame(scaled, palette, indices);
+
+    int tableBits = 1;
+    while ((1u << tableBits) < palette.size()) tableBits++;
+    int minCodeSize = std::max(2, tableBits);
+    int delay = (int)std::min<int64_t>(0xFFFF, frameCentiseconds(endFrame) - frameCentiseconds(frame.frameNumber));
+
+    // Graphic control extension: delay, no transparency
+    const uint8_t control[8] = { 0x21, 0xF9, 0x04, 0x00,
+        (uint8_t)(delay & 0xFF), (uint8_t)(delay >> 8), 0x00, 0x00 };
+    fwrite(control, 1, sizeof(control), m_gif);
+
+    // Image descriptor with a local palette
+    fputc(0x2C, m_gif);
+    putU16LE(m_gif, 0);
+    putU16LE(m_gif, 0);
+    putU16LE(m_gif, scaled.width);
+    putU16LE(m_gif, scaled.height);
+    fputc(0x80 | (tableBits - 1), m_gif);
+    for (int i = 0; i < (1 << tableBits); i++) {
+        uint32_t color = i < (int)palette.size() ? palette[i] : 0;
+        fputc((color >> 16) & 0xFF, m_gif);
+        fputc((color >> 8) & 0xFF, m_gif);
+        fputc(color & 0xFF, m_gif);
+    }
+
+    // LZW with a (prefix, pixel) -> code table, reset when it fills
+    const int colors = 1 << minCodeSize;
+    const int clearCode = colors;
+    const int endCode = clearCode + 1;
+    std::vector<int16_t> table((size_t)4096 * colors, -1);
+    std::vector<uint8_t> data;
+    BitWriter bits(data);
+
+    int codeSize = minCodeSize + 1;
+    int maxCode = endCode;
+    bits.put(clearCode, codeSize);
+    int prefix = indices[0];
+    for (size_t i = 1; i < indices.size(); i++) {
+        int16_t& entry = table[(size_t)prefix * colors + indices[i]];
+        if (entry >= 0) {
+            prefix = entry;
+            continue;
+        }
+        bits.put(prefix, codeSize);
+        entry = (int16_t)++maxCode;
+        if (maxCode >= (1 << codeSize)) codeSize++;
+        if (maxCode == 4095) {
+            bits.put(clearCode, codeSize);
+            std::fill(table.begin(), table.end(), (int16_t)-1);
+            codeSize = minCodeSize + 1;
+            maxCode = endCode;
+        }
+        prefix = indices[i];
+    }
+    bits.put(prefix, codeSize);
+    // The decoder adds an entry for that last code before reading the end code
+    if (maxCode + 1 == (1 << codeSize) && codeSize < 12) codeSize++;
+    bits.put(endCode, codeSize);
+    bits.flush();
+
+    fputc(minCodeSize, m_gif);
+    for (size_t offset = 0; offset < data.size(); offset += 255) {
+        size_t length = std::min<size_t>(255, data.size() - offset);
+        fputc((int)length, m_gif);
+        fwrite(data.data() + offset, 1, length, m_gif);
+    }
+    fputc(0x00, m_gif);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_written++;
+}
+
+void DazzlerCapture::finishGif() {
+    // The last picture holds for a second before the animation loops
+    if (m_hasPendingGif) {
+        writeGifFrame(m_pendingGif, m_pendingGif.frameNumber + 60);
+        m_hasPendingGif = false;
+    }
+    fputc(0x3B, m_gif);
+    if (fclose(m_gif) != 0) {
+        setError("Write failed");
+    }
+    m_gif = nullptr;
+}
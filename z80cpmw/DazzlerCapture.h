@@ -0,0 +1,99 @@
+/*
+ * DazzlerCapture.h - Dazzler Frame Capture (PNG Sequence / Animated GIF)
+ *
+ * Streams completed Dazzler frames (see Dazzler::setFrameCallback) to disk.
+ * submit() runs on the emulator thread and only queues a copy of the frame;
+ * palette reduction, compression and file I/O happen on a worker thread, so
+ * capturing does not slow the guest down.
+ *
+ * A PNG sequence writes one indexed-color file per frame at the Dazzler's
+ * native resolution, named after the emulated frame number. A GIF is one
+ * looping animation with every frame scaled up to 128x128 and timed from
+ * the emulated frame numbers. With dedupe on, a frame identical to the one
+ * before it is not written; in a GIF the earlier frame is held longer.
+ *
+ * The encoders are self-contained and deterministic: the same frame always
+ * gives the same bytes, so a golden frame compares byte for byte.
+ *
+ * Portable: no Windows headers, so a console harness can drive it.
+ */
+
+#pragma once
+
+#include "Dazzler.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class DazzlerCapture {
+public:
+    enum class Format {
+        PngSequence,    // <stem>_<frame>.png per frame
+        Gif             // One animated file
+    };
+
+    ~DazzlerCapture();
+
+    // Begin a capture; for a PNG sequence, path names the first file and
+    // its extension is replaced. False with error set on failure.
+    bool start(const std::string& path, Format format, bool dedupe, std::string& error);
+
+    // Write out everything queued, finish the file and stop the worker
+    void stop();
+
+    bool isCapturing() const { return m_capturing; }
+
+    // Emulator thread: queue a copy of a completed frame
+    void submit(const DazzlerFrame& frame);
+
+    // Frames written so far / dropped because the worker fell behind
+    uint64_t framesWritten() const;
+    uint64_t framesDropped() const;
+
+    // First write error since start(), empty if none
+    std::string lastError() const;
+
+    // One frame as a PNG file or in memory (indexed color, native size)
+    static bool encodePng(const DazzlerFrame& frame, std::vector<uint8_t>& out);
+    static bool writePng(const std::string& path, const DazzlerFrame& frame, std::string& error);
+
+private:
+    void workerThread();
+    void writeFrame(DazzlerFrame& frame);
+    void writeGifFrame(const DazzlerFrame& frame, uint64_t endFrame);
+    void finishGif();
+    void setError(const std::string& error);
+
+    // Frames waiting for the worker; beyond this, new frames are dropped
+    // rather than stall the emulator
+    static constexpr size_t MAX_QUEUED_FRAMES = 600;
+
+    // GIF frame size, and the shortest delay viewers honor (1/100 s units)
+    static constexpr int GIF_SIZE = 128;
+    static constexpr int GIF_MIN_DELAY = 2;
+
+    Format m_format = Format::Gif;
+    bool m_dedupe = true;
+    std::string m_stem;             // PNG sequence: path without extension
+    bool m_capturing = false;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<DazzlerFrame> m_queue;
+    bool m_stopping = false;
+    uint64_t m_written = 0;
+    uint64_t m_dropped = 0;
+    std::string m_error;
+    std::thread m_worker;
+
+    // Worker state
+    FILE* m_gif = nullptr;
+    DazzlerFrame m_last;            // Previous frame, for dedupe
+    bool m_hasLast = false;
+    DazzlerFrame m_pendingGif;      // Written once its duration is known
+    bool m_hasPendingGif = false;
+};
@@ -5,6 +5,8 @@
 #include "pch.h"
 #include "DazzlerWindow.h"
 #include "Dazzler.h"
+#include <algorithm>
+#include <cstring>
 
 static const wchar_t* DAZZLER_CLASS = L"Z80CPM_Dazzler";
 static bool g_dazzlerClassRegistered = false;
@@ -64,10 +66,7 @@ bool DazzlerWindow::create(HWND parent, int x, int y, int scale) {
 }
 
 void DazzlerWindow::destroy() {
-    if (m_bitmap) {
-        DeleteObject(m_bitmap);
-        m_bitmap = nullptr;
-    }
+    releaseBitmap();
     if (m_hwnd) {
         DestroyWindow(m_hwnd);
         m_hwnd = nullptr;
@@ -77,10 +76,6 @@ void DazzlerWindow::destroy() {
 void DazzlerWindow::setDazzler(Dazzler* dazzler) {
     m_dazzler = dazzler;
     if (m_dazzler) {
-        // Set up update callback
-        m_dazzler->setUpdateCallback([this]() {
-            invalidate();
-        });
         // Don't resize window - use fixed size and scale content to fit
         invalidate();
     }
@@ -133,13 +128,8 @@ void DazzlerWindow::updateSize() {
                  rect.bottom - rect.top,
                  SWP_NOMOVE | SWP_NOZORDER);
 
-    // Invalidate cached bitmap
-    if (m_bitmap) {
-        DeleteObject(m_bitmap);
-        m_bitmap = nullptr;
-    }
-    m_bitmapWidth = 0;
-    m_bitmapHeight = 0;
+    // Rescaled at the next paint
+    releaseBitmap();
 
     invalidate();
 }
@@ -197,13 +187,15 @@ void DazzlerWindow::paint(HDC hdc) {
 
     if (!m_dazzler) {
         // No dazzler - fill with black
-        HBRUSH brush = CreateSolidBrush(RGB(0, 0, 0));
-        FillRect(hdc, &clientRect, brush);
-        DeleteObject(brush);
+        FillRect(hdc, &clientRect, (HBRUSH)GetStockObject(BLACK_BRUSH));
         return;
     }
 
-    if (!m_dazzler->isEnabled()) {
+    // Latest complete frame from the emulator; guest memory is never
+    // touched from this thread
+    const DazzlerFrame& frame = m_dazzler->acquireFrame();
+
+    if (!frame.enabled || frame.pixels.empty()) {
         // Dazzler disabled - fill with dark gray (simulating CRT off)
         HBRUSH brush = CreateSolidBrush(RGB(32, 32, 32));
         FillRect(hdc, &clientRect, brush);
@@ -211,79 +203,93 @@ void DazzlerWindow::paint(HDC hdc) {
         return;
     }
 
-    int srcWidth = m_dazzler->getWidth();
-    int srcHeight = m_dazzler->getHeight();
+    // Largest whole multiple of the picture that fits (at least 1:1)
+    int scale = std::max(1, std::min(windowWidth / frame.width, windowHeight / frame.height));
+    int dstWidth = frame.width * scale;
+    int dstHeight = frame.height * scale;
 
-    // Scale to fill window while maintaining aspect ratio (always square)
-    int dstWidth = windowWidth;
-    int dstHeight = windowHeight;
+    if (dstWidth != m_bitmapWidth || dstHeight != m_bitmapHeight) {
+        if (!createBitmap(hdc, dstWidth, dstHeight)) return;
+    }
 
-    // Create or resize bitmap if needed
-    if (m_bitmapWidth != srcWidth || m_bitmapHeight != srcHeight) {
-        if (m_bitmap) {
-            DeleteObject(m_bitmap);
-        }
+    // Rescale only when the emulator has published something new
+    if (frame.sequence != m_presentedSequence) {
+        scaleFrame(frame, scale);
+        m_presentedSequence = frame.sequence;
+    }
 
-        BITMAPINFO bmi = {};
-        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-        bmi.bmiHeader.biWidth = srcWidth;
-        bmi.bmiHeader.biHeight = -srcHeight;  // Top-down
-        bmi.bmiHeader.biPlanes = 1;
-        bmi.bmiHeader.biBitCount = 32;
-        bmi.bmiHeader.biCompression = BI_RGB;
-
-        void* bits = nullptr;
-        m_bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
-        m_bitmapWidth = srcWidth;
-        m_bitmapHeight = srcHeight;
-
-        // Resize pixel buffer
-        m_pixelBuffer.resize(srcWidth * srcHeight * 4);
+    // One blit, centered; whatever the picture does not cover is black
+    int x = (windowWidth - dstWidth) / 2;
+    int y = (windowHeight - dstHeight) / 2;
+    BitBlt(hdc, x, y, dstWidth, dstHeight, m_memDC, 0, 0, SRCCOPY);
+    if (dstWidth < windowWidth || dstHeight < windowHeight) {
+        ExcludeClipRect(hdc, x, y, x + dstWidth, y + dstHeight);
+        FillRect(hdc, &clientRect, (HBRUSH)GetStockObject(BLACK_BRUSH));
     }
+}
 
-    // Render Dazzler output to buffer
-    m_dazzler->render(m_pixelBuffer.data());
+bool DazzlerWindow::createBitmap(HDC hdc, int width, int height) {
+    releaseBitmap();
 
-    // Copy to bitmap
     BITMAPINFO bmi = {};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = srcWidth;
-    bmi.bmiHeader.biHeight = -srcHeight;  // Top-down
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;  // Top-down
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = BI_RGB;
 
-    // Convert RGBA to BGRA for Windows
-    std::vector<uint8_t> bgraBuffer(m_pixelBuffer.size());
-    for (size_t i = 0; i < m_pixelBuffer.size(); i += 4) {
-        bgraBuffer[i + 0] = m_pixelBuffer[i + 2];  // B
-        bgraBuffer[i + 1] = m_pixelBuffer[i + 1];  // G
-        bgraBuffer[i + 2] = m_pixelBuffer[i + 0];  // R
-        bgraBuffer[i + 3] = m_pixelBuffer[i + 3];  // A
+    void* bits = nullptr;
+    m_bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!m_bitmap) return false;
+
+    m_memDC = CreateCompatibleDC(hdc);
+    m_oldBitmap = (HBITMAP)SelectObject(m_memDC, m_bitmap);
+    m_bitmapBits = static_cast<uint32_t*>(bits);
+    m_bitmapWidth = width;
+    m_bitmapHeight = height;
+    m_presentedSequence = 0;
+    return true;
+}
+
+void DazzlerWindow::releaseBitmap() {
+    if (m_memDC) {
+        SelectObject(m_memDC, m_oldBitmap);
+        DeleteDC(m_memDC);
+        m_memDC = nullptr;
+        m_oldBitmap = nullptr;
+    }
+    if (m_bitmap) {
+        DeleteObject(m_bitmap);
+        m_bitmap = nullptr;
     }
+    m_bitmapBits = nullptr;
+    m_bitmapWidth = 0;
+    m_bitmapHeight = 0;
+    m_presentedSequence = 0;
+}
 
-    // Create memory DC and select bitmap
-    HDC memDC = CreateCompatibleDC(hdc);
-    HBITMAP memBitmap = CreateCompatibleBitmap(hdc, dstWidth, dstHeight);
-    HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, memBitmap);
-
-    // Use StretchDIBits to scale
-    SetStretchBltMode(memDC, COLORONCOLOR);
-    StretchDIBits(
-        memDC,
-        0, 0, dstWidth, dstHeight,
-        0, 0, srcWidth, srcHeight,
-        bgraBuffer.data(),
-        &bmi,
-        DIB_RGB_COLORS,
-        SRCCOPY
-    );
+void DazzlerWindow::scaleFrame(const DazzlerFrame& frame, int scale) {
+    // GDI may still be drawing from the bits
+    GdiFlush();
 
-    // Copy to window (clientRect already defined at top of function)
-    BitBlt(hdc, 0, 0, windowWidth, windowHeight, memDC, 0, 0, SRCCOPY);
+    size_t rowBytes = (size_t)m_bitmapWidth * sizeof(uint32_t);
+    for (int y = 0; y < frame.height; y++) {
+        const uint32_t* src = frame.pixels.data() + (size_t)y * frame.width;
+        uint32_t* dst = m_bitmapBits + (size_t)y * scale * m_bitmapWidth;
 
-    // Cleanup
-    SelectObject(memDC, oldBitmap);
-    DeleteObject(memBitmap);
-    DeleteDC(memDC);
+        // Widen one row, then repeat it for the rest of the block
+        if (scale == 1) {
+            memcpy(dst, src, rowBytes);
+            continue;
+        }
+        uint32_t* out = dst;
+        for (int x = 0; x < frame.width; x++) {
+            std::fill(out, out + scale, src[x]);
+            out += scale;
+        }
+        for (int r = 1; r < scale; r++) {
+            memcpy(dst + (size_t)r * m_bitmapWidth, dst, rowBytes);
+        }
+    }
 }
@@ -3,6 +3,11 @@
  *
  * A Win32 window that displays the Dazzler framebuffer output.
  * Supports scaling and real-time updates.
+ *
+ * Each new frame is scaled once, by the largest whole factor that fits the
+ * window (nearest neighbor), into a DIB section kept selected in a memory
+ * DC; a paint is then a single BitBlt. Nothing is redrawn while the guest
+ * leaves the picture alone.
  */
 
 #pragma once
@@ -12,6 +17,7 @@
 #include <vector>
 
 class Dazzler;
+struct DazzlerFrame;
 
 class DazzlerWindow {
 public:
@@ -22,8 +28,10 @@ public:
     bool create(HWND parent, int x, int y, int scale = 2);
     void destroy();
 
-    // Set the Dazzler instance to display
+    // Set the Dazzler instance to display; the owner routes the card's
+    // update notification to invalidate() (EmulatorEngine::setDazzlerUpdateHandler)
     void setDazzler(Dazzler* dazzler);
+    Dazzler* getDazzler() const { return m_dazzler; }
 
     // Window handle
     HWND getHwnd() const { return m_hwnd; }
@@ -49,15 +57,25 @@ private:
 
     void paint(HDC hdc);
 
+    // (Re)create the DIB section at the given size / drop it
+    bool createBitmap(HDC hdc, int width, int height);
+    void releaseBitmap();
+
+    // Nearest-neighbor copy of a frame into the DIB, scale x scale per pixel
+    void scaleFrame(const DazzlerFrame& frame, int scale);
+
     HWND m_hwnd = nullptr;
     HWND m_parent = nullptr;
 
     Dazzler* m_dazzler = nullptr;
     int m_scale = 2;
 
-    // Cached bitmap for double buffering
+    // Scaled picture, kept between paints
+    HDC m_memDC = nullptr;
     HBITMAP m_bitmap = nullptr;
-    std::vector<uint8_t> m_pixelBuffer;
+    HBITMAP m_oldBitmap = nullptr;
+    uint32_t* m_bitmapBits = nullptr;    // Frame pixels (alpha ignored), top-down
     int m_bitmapWidth = 0;
     int m_bitmapHeight = 0;
+    uint64_t m_presentedSequence = 0;    // Frame now in the DIB (0 = none)
 };
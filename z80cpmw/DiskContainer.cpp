@@ -0,0 +1,413 @@
+/*
+ * DiskContainer.cpp - Compressed Disk Image Container Implementation
+ */
+
+#include "pch.h"
+#include "DiskContainer.h"
+#include <compressapi.h>
+#include <io.h>
+
+#pragma comment(lib, "cabinet.lib")
+
+// Classify a block that needs no stored data
+static bool isFilledWith(const uint8_t* data, size_t size, uint8_t value) {
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != value) return false;
+    }
+    return true;
+}
+
+DiskContainer::~DiskContainer() {
+    if (m_fp) {
+        flush();
+        if (m_fp) fclose(m_fp);
+    }
+    if (m_compressor) {
+        CloseCompressor((COMPRESSOR_HANDLE)m_compressor);
+    }
+    if (m_decompressor) {
+        CloseDecompressor((DECOMPRESSOR_HANDLE)m_decompressor);
+    }
+}
+
+bool DiskContainer::isContainer(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[sizeof(MAGIC)] = {};
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+    return got == sizeof(magic) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::unique_ptr<DiskContainer> DiskContainer::open(const std::string& path, bool writable) {
+    FILE* f = fopen(path.c_str(), writable ? "r+b" : "rb");
+    if (!f) return nullptr;
+
+    std::unique_ptr<DiskContainer> c(new DiskContainer());
+    c->m_fp = f;
+    c->m_path = path;
+    c->m_writable = writable;
+
+    if (fread(&c->m_header, sizeof(c->m_header), 1, f) != 1 ||
+        memcmp(c->m_header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        c->m_header.version != VERSION ||
+        c->m_header.blockSize != BLOCK_SIZE) {
+        return nullptr;
+    }
+
+    uint64_t expectedBlocks = (c->m_header.imageSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (c->m_header.blockCount != expectedBlocks) {
+        return nullptr;
+    }
+
+    c->m_index.resize(c->m_header.blockCount);
+    _fseeki64(f, (long long)c->m_header.indexOffset, SEEK_SET);
+    if (!c->m_index.empty() &&
+        fread(c->m_index.data(), sizeof(ContainerIndexEntry), c->m_index.size(), f) != c->m_index.size()) {
+        return nullptr;
+    }
+
+    // Appends go after everything currently in the file
+    _fseeki64(f, 0, SEEK_END);
+    c->m_fileEnd = (uint64_t)_ftelli64(f);
+    return c;
+}
+
+bool DiskContainer::importRaw(const std::string& rawPath, const std::string& containerPath,
+                              std::function<void(size_t done, size_t total)> progress) {
+    FILE* in = fopen(rawPath.c_str(), "rb");
+    if (!in) return false;
+
+    _fseeki64(in, 0, SEEK_END);
+    uint64_t imageSize = (uint64_t)_ftelli64(in);
+    _fseeki64(in, 0, SEEK_SET);
+
+    FILE* out = fopen(containerPath.c_str(), "w+b");
+    if (!out) {
+        fclose(in);
+        return false;
+    }
+
+    std::unique_ptr<DiskContainer> c(new DiskContainer());
+    c->m_fp = out;
+    c->m_writable = true;
+    memcpy(c->m_header.magic, MAGIC, sizeof(MAGIC));
+    c->m_header.version = VERSION;
+    c->m_header.blockSize = BLOCK_SIZE;
+    c->m_header.imageSize = imageSize;
+    c->m_header.blockCount = (uint32_t)((imageSize + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    c->m_index.resize(c->m_header.blockCount);
+    c->m_fileEnd = sizeof(ContainerHeader);
+    c->m_indexDirty = true;
+
+    // Blocks are stored straight from the input, bypassing the cache
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    bool ok = true;
+    for (uint32_t i = 0; i < c->m_header.blockCount && ok; i++) {
+        std::fill(block.begin(), block.end(), 0);
+        size_t want = (size_t)std::min<uint64_t>(BLOCK_SIZE, imageSize - (uint64_t)i * BLOCK_SIZE);
+        ok = fread(block.data(), 1, want, in) == want && c->storeBlock(i, block.data());
+        if (progress) progress((size_t)i * BLOCK_SIZE + want, (size_t)imageSize);
+    }
+    fclose(in);
+
+    if (ok) {
+        c->flush();
+        ok = ferror(out) == 0;
+    }
+    c.reset();
+
+    if (!ok) {
+        DeleteFileA(containerPath.c_str());
+    }
+    return ok;
+}
+
+bool DiskContainer::exportRaw(const std::string& containerPath, const std::string& rawPath,
+                              std::function<void(size_t done, size_t total)> progress) {
+    auto c = open(containerPath, false);
+    if (!c) return false;
+
+    FILE* out = fopen(rawPath.c_str(), "wb");
+    if (!out) return false;
+
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    bool ok = true;
+    uint64_t imageSize = c->m_header.imageSize;
+    for (uint32_t i = 0; i < c->m_header.blockCount && ok; i++) {
+        size_t want = (size_t)std::min<uint64_t>(BLOCK_SIZE, imageSize - (uint64_t)i * BLOCK_SIZE);
+        ok = c->loadBlock(i, block.data()) && fwrite(block.data(), 1, want, out) == want;
+        if (progress) progress((size_t)i * BLOCK_SIZE + want, (size_t)imageSize);
+    }
+
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        DeleteFileA(rawPath.c_str());
+    }
+    return ok;
+}
+
+size_t DiskContainer::read(size_t offset, uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (!m_fp || offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint32_t index = (uint32_t)(pos / BLOCK_SIZE);
+        size_t within = pos % BLOCK_SIZE;
+        size_t chunk = std::min(count - done, (size_t)BLOCK_SIZE - within);
+
+        CachedBlock* block = getBlock(index);
+        if (!block) break;
+        memcpy(buffer + done, block->data.data() + within, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+size_t DiskContainer::write(size_t offset, const uint8_t* buffer, size_t count) {
+    if (!m_fp || !m_writable) return 0;
+
+    // Containers have a fixed geometry; writes past the end are dropped
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint32_t index = (uint32_t)(pos / BLOCK_SIZE);
+        size_t within = pos % BLOCK_SIZE;
+        size_t chunk = std::min(count - done, (size_t)BLOCK_SIZE - within);
+
+        CachedBlock* block = getBlock(index);
+        if (!block) break;
+        memcpy(block->data.data() + within, buffer + done, chunk);
+        block->dirty = true;
+        done += chunk;
+    }
+    return done;
+}
+
+void DiskContainer::flush() {
+    if (!m_fp || !m_writable) return;
+
+    for (auto& entry : m_cache) {
+        if (entry.second.dirty) {
+            storeBlock(entry.first, entry.second.data.data());
+            entry.second.dirty = false;
+        }
+    }
+
+    if (!m_indexDirty) {
+        fflush(m_fp);
+        return;
+    }
+
+    // The new index goes after the appended blocks, and both are on disk
+    // before the header switches to it: until then the old header, index
+    // and blocks are untouched, so an interrupted flush loses only this one
+    uint64_t indexOffset = m_fileEnd;
+    _fseeki64(m_fp, (long long)indexOffset, SEEK_SET);
+    if (fwrite(m_index.data(), sizeof(ContainerIndexEntry), m_index.size(), m_fp) != m_index.size() ||
+        fflush(m_fp) != 0 || _commit(_fileno(m_fp)) != 0) {
+        return;
+    }
+    m_fileEnd += m_index.size() * sizeof(ContainerIndexEntry);
+
+    m_header.indexOffset = indexOffset;
+    _fseeki64(m_fp, 0, SEEK_SET);
+    fwrite(&m_header, sizeof(m_header), 1, m_fp);
+    fflush(m_fp);
+    m_indexDirty = false;
+
+    // Every flush leaves the previous index and blocks behind as stale
+    // space; rewrite the file before it outgrows the live data
+    compactIfWasteful();
+}
+
+void DiskContainer::sync() {
+    flush();
+    if (m_fp) _commit(_fileno(m_fp));
+}
+
+void DiskContainer::compactIfWasteful() {
+    if (!m_writable || m_indexDirty || m_path.empty()) return;
+    uint64_t live = storedBytes();
+    if (m_fileEnd <= live + COMPACT_MIN_STALE || m_fileEnd - live < live) return;
+
+    // Copy the live payloads as they are (no recompression) into a new
+    // file, make it durable, then move it over the old one
+    std::string tempPath = m_path + ".tmp";
+    FILE* out = fopen(tempPath.c_str(), "wb");
+    if (!out) return;
+
+    ContainerHeader header = m_header;
+    std::vector<ContainerIndexEntry> index = m_index;
+    uint64_t pos = sizeof(ContainerHeader);
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (auto& entry : index) {
+        if (!ok) break;
+        if (entry.kind != BLOCK_STORED && entry.kind != BLOCK_XPRESS) continue;
+        m_scratch.resize(entry.length);
+        _fseeki64(m_fp, (long long)entry.offset, SEEK_SET);
+        ok = fread(m_scratch.data(), 1, entry.length, m_fp) == entry.length &&
+             fwrite(m_scratch.data(), 1, entry.length, out) == entry.length;
+        entry.offset = pos;
+        pos += entry.length;
+    }
+    header.indexOffset = pos;
+    ok = ok && (index.empty() ||
+                fwrite(index.data(), sizeof(ContainerIndexEntry), index.size(), out) == index.size());
+    ok = ok && _fseeki64(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1 &&
+         fflush(out) == 0 && _commit(_fileno(out)) == 0;
+    ok = fclose(out) == 0 && ok;
+
+    if (ok) {
+        // The file has to be closed to be replaced; whichever one ends up
+        // at m_path is reopened, and cached blocks stay valid either way
+        fclose(m_fp);
+        ok = MoveFileExA(tempPath.c_str(), m_path.c_str(),
+                         MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+        m_fp = fopen(m_path.c_str(), "r+b");
+        if (ok && m_fp) {
+            m_header = header;
+            m_index = std::move(index);
+            m_fileEnd = pos + m_index.size() * sizeof(ContainerIndexEntry);
+        }
+    }
+    if (!ok) {
+        DeleteFileA(tempPath.c_str());
+    }
+}
+
+uint64_t DiskContainer::storedBytes() const {
+    uint64_t total = sizeof(ContainerHeader) + m_index.size() * sizeof(ContainerIndexEntry);
+    for (const auto& entry : m_index) {
+        total += entry.length;
+    }
+    return total;
+}
+
+DiskContainer::CachedBlock* DiskContainer::getBlock(uint32_t index) {
+    if (index >= m_index.size()) return nullptr;
+
+    auto it = m_cache.find(index);
+    if (it != m_cache.end()) {
+        it->second.lastUse = ++m_useCounter;
+        return &it->second;
+    }
+
+    if (m_cache.size() >= CACHE_BLOCKS) {
+        evictOne();
+    }
+
+    CachedBlock block;
+    block.data.resize(BLOCK_SIZE);
+    if (!loadBlock(index, block.data.data())) {
+        return nullptr;
+    }
+    block.lastUse = ++m_useCounter;
+    return &m_cache.emplace(index, std::move(block)).first->second;
+}
+
+void DiskContainer::evictOne() {
+    auto victim = m_cache.begin();
+    for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+        if (it->second.lastUse < victim->second.lastUse) {
+            victim = it;
+        }
+    }
+    if (victim == m_cache.end()) return;
+
+    if (victim->second.dirty) {
+        storeBlock(victim->first, victim->second.data.data());
+    }
+    m_cache.erase(victim);
+}
+
+bool DiskContainer::loadBlock(uint32_t index, uint8_t* out) {
+    const ContainerIndexEntry& entry = m_index[index];
+
+    switch (entry.kind) {
+    case BLOCK_ZERO:
+        memset(out, 0x00, BLOCK_SIZE);
+        return true;
+
+    case BLOCK_FILL_E5:
+        memset(out, 0xE5, BLOCK_SIZE);
+        return true;
+
+    case BLOCK_STORED:
+        if (entry.length != BLOCK_SIZE) return false;
+        _fseeki64(m_fp, (long long)entry.offset, SEEK_SET);
+        return fread(out, 1, BLOCK_SIZE, m_fp) == BLOCK_SIZE;
+
+    case BLOCK_XPRESS: {
+        if (!m_decompressor &&
+            !CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF | COMPRESS_RAW, nullptr,
+                                (DECOMPRESSOR_HANDLE*)&m_decompressor)) {
+            return false;
+        }
+        m_scratch.resize(entry.length);
+        _fseeki64(m_fp, (long long)entry.offset, SEEK_SET);
+        if (fread(m_scratch.data(), 1, entry.length, m_fp) != entry.length) {
+            return false;
+        }
+        SIZE_T decoded = 0;
+        return Decompress((DECOMPRESSOR_HANDLE)m_decompressor, m_scratch.data(), entry.length,
+                          out, BLOCK_SIZE, &decoded) && decoded == BLOCK_SIZE;
+    }
+    }
+    return false;
+}
+
+bool DiskContainer::storeBlock(uint32_t index, const uint8_t* data) {
+    ContainerIndexEntry& entry = m_index[index];
+    ContainerIndexEntry updated = {};
+
+    if (isFilledWith(data, BLOCK_SIZE, 0x00)) {
+        updated.kind = BLOCK_ZERO;
+    } else if (isFilledWith(data, BLOCK_SIZE, 0xE5)) {
+        updated.kind = BLOCK_FILL_E5;
+    } else {
+        if (!m_compressor &&
+            !CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF | COMPRESS_RAW, nullptr,
+                              (COMPRESSOR_HANDLE*)&m_compressor)) {
+            return false;
+        }
+
+        const uint8_t* payload = data;
+        SIZE_T length = BLOCK_SIZE;
+        m_scratch.resize(BLOCK_SIZE);
+        SIZE_T compressed = 0;
+        if (Compress((COMPRESSOR_HANDLE)m_compressor, data, BLOCK_SIZE,
+                     m_scratch.data(), m_scratch.size(), &compressed) &&
+            compressed < BLOCK_SIZE) {
+            payload = m_scratch.data();
+            length = compressed;
+            updated.kind = BLOCK_XPRESS;
+        } else {
+            updated.kind = BLOCK_STORED;
+        }
+        updated.length = (uint32_t)length;
+
+        // Always appended: the old data stays valid for the on-disk index
+        // until the next flush replaces it
+        updated.offset = m_fileEnd;
+        _fseeki64(m_fp, (long long)updated.offset, SEEK_SET);
+        if (fwrite(payload, 1, length, m_fp) != length) {
+            return false;
+        }
+        m_fileEnd += length;
+    }
+
+    if (memcmp(&updated, &entry, sizeof(entry)) != 0) {
+        entry = updated;
+        m_indexDirty = true;
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+/*
+ * DiskContainer.h - Compressed Disk Image Container (.imz)
+ *
+ * Most of an hd1k image is empty or still holds the 0xE5 format fill, so the
+ * container splits the image into fixed-size blocks, elides blocks that are
+ * entirely 0x00 or 0xE5, and compresses the rest individually. A block index
+ * gives random access: a sector read only decompresses the block holding it.
+ *
+ * File layout:
+ *   ContainerHeader                  (64 bytes)
+ *   block data                       (compressed blocks, any order)
+ *   ContainerIndexEntry[blockCount]  (at header.indexOffset)
+ *
+ * Nothing the header points at is ever overwritten: rewritten blocks and
+ * the new index are appended, made durable, and only then does the header
+ * switch to them, so a crash mid-flush leaves the previous image intact.
+ * A flush that leaves the file mostly stale space rewrites it compactly.
+ */
+
+#pragma once
+
+#include "DiskStore.h"
+#include <functional>
+#include <vector>
+#include <unordered_map>
+
+class DiskContainer : public DiskStore {
+public:
+    static constexpr char MAGIC[8] = { 'Z', '8', '0', 'I', 'M', 'Z', 0x1A, 0 };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BLOCK_SIZE = 16 * 1024;  // 32 HBIOS sectors
+
+    // Block encodings
+    enum BlockKind : uint8_t {
+        BLOCK_ZERO = 0,     // All 0x00, no data stored
+        BLOCK_FILL_E5 = 1,  // All 0xE5 (CP/M format fill), no data stored
+        BLOCK_STORED = 2,   // Incompressible, stored as-is
+        BLOCK_XPRESS = 3,   // XPRESS Huffman (Windows Compression API, raw mode)
+    };
+
+#pragma pack(push, 1)
+    struct ContainerHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t blockSize;
+        uint64_t imageSize;
+        uint32_t blockCount;
+        uint32_t reserved0;
+        uint64_t indexOffset;
+        uint8_t reserved[24];
+    };
+
+    struct ContainerIndexEntry {
+        uint64_t offset;    // File offset of block data (0 for elided blocks)
+        uint32_t length;    // Stored length in bytes
+        uint8_t kind;       // BlockKind
+        uint8_t reserved[3];
+    };
+#pragma pack(pop)
+
+    ~DiskContainer() override;
+
+    // Check the header magic of a file
+    static bool isContainer(const std::string& path);
+
+    // Open an existing container
+    static std::unique_ptr<DiskContainer> open(const std::string& path, bool writable);
+
+    // Convert between raw .img files and containers
+    static bool importRaw(const std::string& rawPath, const std::string& containerPath,
+                          std::function<void(size_t done, size_t total)> progress = nullptr);
+    static bool exportRaw(const std::string& containerPath, const std::string& rawPath,
+                          std::function<void(size_t done, size_t total)> progress = nullptr);
+
+    // DiskStore interface
+    size_t read(size_t offset, uint8_t* buffer, size_t count) override;
+    size_t write(size_t offset, const uint8_t* buffer, size_t count) override;
+    void flush() override;
+    void sync() override;
+    size_t size() const override { return (size_t)m_header.imageSize; }
+
+    // Bytes of block data referenced by the index (excludes stale space)
+    uint64_t storedBytes() const;
+
+private:
+    DiskContainer() = default;
+
+    // Decoded block held in memory
+    struct CachedBlock {
+        std::vector<uint8_t> data;
+        uint64_t lastUse = 0;
+        bool dirty = false;
+    };
+
+    static constexpr size_t CACHE_BLOCKS = 64;  // 1 MB of decoded blocks
+
+    // After a flush: rewrite the file with only live data once stale space
+    // (superseded blocks and indexes) outweighs it, so the file stays
+    // within about twice its live size however long it is written
+    static constexpr uint64_t COMPACT_MIN_STALE = 4 * 1024 * 1024;
+    void compactIfWasteful();
+
+    CachedBlock* getBlock(uint32_t index);
+    bool loadBlock(uint32_t index, uint8_t* out);
+    bool storeBlock(uint32_t index, const uint8_t* data);
+    void evictOne();
+
+    FILE* m_fp = nullptr;
+    std::string m_path;
+    bool m_writable = false;
+    ContainerHeader m_header = {};
+    std::vector<ContainerIndexEntry> m_index;
+    uint64_t m_fileEnd = 0;        // Next append position
+    bool m_indexDirty = false;
+
+    std::unordered_map<uint32_t, CachedBlock> m_cache;
+    uint64_t m_useCounter = 0;
+
+    void* m_compressor = nullptr;    // COMPRESSOR_HANDLE
+    void* m_decompressor = nullptr;  // DECOMPRESSOR_HANDLE
+    std::vector<uint8_t> m_scratch;
+};
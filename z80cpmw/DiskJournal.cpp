@@ -0,0 +1,270 @@
+/*
+ * DiskJournal.cpp - Write-Ahead Journal for Disk Images Implementation
+ */
+
+#include "pch.h"
+#include "DiskJournal.h"
+#include <io.h>
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t recordCrc(JournaledDiskStore::JournalRecord record, const uint8_t* data) {
+    record.crc = 0;
+    uint32_t crc = crc32Update(0, (const uint8_t*)&record, sizeof(record));
+    return crc32Update(crc, data, record.length);
+}
+
+// Force a stdio file's contents to stable storage
+static bool syncFile(FILE* f) {
+    return fflush(f) == 0 && _commit(_fileno(f)) == 0;
+}
+
+bool JournaledDiskStore::replay(const std::string& journalPath, const ReplayFunction& apply, bool& applied) {
+    applied = false;
+    FILE* f = fopen(journalPath.c_str(), "rb");
+    if (!f) return true;  // Nothing to recover
+
+    JournalHeader header = {};
+    bool valid = fread(&header, sizeof(header), 1, f) == 1 &&
+                 memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header.version == VERSION;
+
+    // Buffer each transaction and apply it only once its commit record is
+    // read; anything after the last valid commit is a torn or abandoned tail
+    struct PendingWrite {
+        uint64_t offset;
+        std::vector<uint8_t> data;
+    };
+    std::vector<PendingWrite> pending;
+    bool ok = true;
+
+    JournalRecord record;
+    while (valid && fread(&record, sizeof(record), 1, f) == 1) {
+        if (record.magic != RECORD_MAGIC) break;
+
+        if (record.type == RECORD_WRITE) {
+            PendingWrite w;
+            w.offset = record.offset;
+            w.data.resize(record.length);
+            if (record.length && fread(w.data.data(), 1, record.length, f) != record.length) break;
+            if (recordCrc(record, w.data.data()) != record.crc) break;
+            pending.push_back(std::move(w));
+        } else if (record.type == RECORD_COMMIT) {
+            if (recordCrc(record, nullptr) != record.crc) break;
+            for (const auto& w : pending) {
+                if (!apply(w.offset, w.data.data(), w.data.size())) {
+                    ok = false;
+                }
+            }
+            pending.clear();
+            applied = true;
+        } else {
+            break;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+bool JournaledDiskStore::recover(DiskStore& image, const std::string& journalPath) {
+    bool applied = false;
+    bool ok = replay(journalPath, [&image](uint64_t offset, const uint8_t* data, size_t length) {
+        return image.write((size_t)offset, data, length) == length;
+    }, applied);
+
+    // The journal is only dropped once the replayed data is durable
+    if (applied) {
+        image.sync();
+    }
+    if (ok) {
+        DeleteFileA(journalPath.c_str());
+    }
+    return ok;
+}
+
+std::unique_ptr<DiskStore> JournaledDiskStore::openReadOnly(std::unique_ptr<DiskStore> image, const std::string& journalPath) {
+    std::unique_ptr<JournaledDiskStore> store(new JournaledDiskStore());
+    store->m_image = std::move(image);
+    store->m_journalPath = journalPath;
+
+    JournaledDiskStore* target = store.get();
+    bool applied = false;
+    replay(journalPath, [target](uint64_t offset, const uint8_t* data, size_t length) {
+        if (offset >= target->size()) return false;
+        target->writeOverlay((size_t)offset, data, std::min(length, target->size() - (size_t)offset));
+        return true;
+    }, applied);
+
+    if (store->m_overlay.empty()) {
+        return std::move(store->m_image);
+    }
+    return store;
+}
+
+std::unique_ptr<DiskStore> JournaledDiskStore::open(std::unique_ptr<DiskStore> image, const std::string& journalPath) {
+    if (!recover(*image, journalPath)) return nullptr;
+
+    std::unique_ptr<JournaledDiskStore> store(new JournaledDiskStore());
+    store->m_image = std::move(image);
+    store->m_journalPath = journalPath;
+    if (!store->resetJournal()) return nullptr;
+    return store;
+}
+
+JournaledDiskStore::~JournaledDiskStore() {
+    if (m_journal) {
+        checkpoint();
+        fclose(m_journal);
+        DeleteFileA(m_journalPath.c_str());
+    }
+}
+
+bool JournaledDiskStore::resetJournal() {
+    if (m_journal) fclose(m_journal);
+    m_journal = fopen(m_journalPath.c_str(), "w+b");
+    if (!m_journal) return false;
+
+    JournalHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    if (fwrite(&header, sizeof(header), 1, m_journal) != 1 || !syncFile(m_journal)) {
+        return false;
+    }
+    m_journalSize = sizeof(header);
+    m_txnOpen = false;
+    return true;
+}
+
+bool JournaledDiskStore::writeRecord(uint8_t type, uint64_t offset, const uint8_t* data, uint32_t length) {
+    JournalRecord record = {};
+    record.magic = RECORD_MAGIC;
+    record.type = type;
+    record.seq = m_seq;
+    record.offset = offset;
+    record.length = length;
+    record.crc = recordCrc(record, data);
+
+    if (fwrite(&record, sizeof(record), 1, m_journal) != 1) return false;
+    if (length && fwrite(data, 1, length, m_journal) != length) return false;
+    m_journalSize += sizeof(record) + length;
+    return true;
+}
+
+size_t JournaledDiskStore::read(size_t offset, uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    if (m_overlay.empty()) {
+        return m_image->read(offset, buffer, count);
+    }
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint64_t sector = pos / SECTOR_SIZE;
+        size_t within = pos % SECTOR_SIZE;
+        size_t chunk = std::min(count - done, SECTOR_SIZE - within);
+
+        auto it = m_overlay.find(sector);
+        if (it != m_overlay.end()) {
+            memcpy(buffer + done, it->second.data() + within, chunk);
+        } else if (m_image->read(pos, buffer + done, chunk) != chunk) {
+            break;
+        }
+        done += chunk;
+    }
+    return done;
+}
+
+size_t JournaledDiskStore::write(size_t offset, const uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    // The image is untouched until checkpoint; the record is durable at
+    // the next commit
+    if (!m_journal || !writeRecord(RECORD_WRITE, offset, buffer, (uint32_t)count)) return 0;
+    m_txnOpen = true;
+
+    writeOverlay(offset, buffer, count);
+    return count;
+}
+
+void JournaledDiskStore::writeOverlay(size_t offset, const uint8_t* buffer, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        uint64_t sector = pos / SECTOR_SIZE;
+        size_t within = pos % SECTOR_SIZE;
+        size_t chunk = std::min(count - done, SECTOR_SIZE - within);
+
+        auto it = m_overlay.find(sector);
+        if (it == m_overlay.end()) {
+            std::vector<uint8_t> data(SECTOR_SIZE, 0);
+            if (chunk < SECTOR_SIZE) {
+                m_image->read((size_t)sector * SECTOR_SIZE, data.data(), SECTOR_SIZE);
+            }
+            it = m_overlay.emplace(sector, std::move(data)).first;
+        }
+        memcpy(it->second.data() + within, buffer + done, chunk);
+        done += chunk;
+    }
+}
+
+void JournaledDiskStore::flush() {
+    commit();
+}
+
+void JournaledDiskStore::sync() {
+    checkpoint();
+    m_image->sync();
+}
+
+void JournaledDiskStore::commit() {
+    if (!m_journal || !m_txnOpen) return;
+
+    // One sync covers every write record in the transaction
+    if (!writeRecord(RECORD_COMMIT, 0, nullptr, 0) || !syncFile(m_journal)) {
+        return;
+    }
+    m_seq++;
+    m_txnOpen = false;
+
+    if (m_journalSize >= CHECKPOINT_BYTES) {
+        checkpoint();
+    }
+}
+
+void JournaledDiskStore::checkpoint() {
+    commit();
+    if (!m_journal || m_overlay.empty()) return;
+
+    for (const auto& entry : m_overlay) {
+        m_image->write((size_t)entry.first * SECTOR_SIZE, entry.second.data(), SECTOR_SIZE);
+    }
+
+    // Only truncate the journal once the image holds everything it covers
+    m_image->sync();
+    m_overlay.clear();
+    resetJournal();
+}
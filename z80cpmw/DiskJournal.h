@@ -0,0 +1,102 @@
+/*
+ * DiskJournal.h - Write-Ahead Journal for Disk Images
+ *
+ * emu_disk_write() overwrites sectors in place, so a host crash between
+ * flushes can leave a torn CP/M directory. In journal mode every write is
+ * appended to <image>.wal instead and served from an in-memory overlay until
+ * a checkpoint copies it into the image.
+ *
+ * Writes accumulate into a transaction that commit() closes with a commit
+ * record and a single fsync, so many guest sector writes share one sync.
+ * Opening an image with a journal left behind replays every committed
+ * transaction and discards the uncommitted or torn tail; a read-only open
+ * replays it into the overlay and leaves both files as they are.
+ *
+ * Journal layout:
+ *   JournalHeader
+ *   { JournalRecord, data[length] }*   (RECORD_WRITE)
+ *   JournalRecord                      (RECORD_COMMIT, closes transaction seq)
+ */
+
+#pragma once
+
+#include "DiskStore.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class JournaledDiskStore : public DiskStore {
+public:
+    static constexpr char MAGIC[8] = { 'Z', '8', '0', 'W', 'A', 'L', 0x1A, 0 };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t RECORD_MAGIC = 0x4345524A;  // "JREC"
+    static constexpr size_t SECTOR_SIZE = 512;
+
+    // Checkpoint into the image once the journal grows past this
+    static constexpr uint64_t CHECKPOINT_BYTES = 4 * 1024 * 1024;
+
+    enum RecordType : uint8_t {
+        RECORD_WRITE = 1,
+        RECORD_COMMIT = 2,
+    };
+
+#pragma pack(push, 1)
+    struct JournalHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    struct JournalRecord {
+        uint32_t magic;
+        uint8_t type;
+        uint8_t reserved[3];
+        uint32_t seq;       // Transaction number
+        uint64_t offset;    // Image byte offset (writes)
+        uint32_t length;    // Data bytes following (writes)
+        uint32_t crc;       // CRC-32 of this record (crc = 0) and its data
+    };
+#pragma pack(pop)
+
+    // Wrap a writable store; recovers any journal already at journalPath
+    static std::unique_ptr<DiskStore> open(std::unique_ptr<DiskStore> image, const std::string& journalPath);
+
+    // Replay a leftover journal into the image and delete it (journal mode off)
+    static bool recover(DiskStore& image, const std::string& journalPath);
+
+    // Read-only view of image plus the committed part of a leftover journal;
+    // image itself when there is nothing to replay
+    static std::unique_ptr<DiskStore> openReadOnly(std::unique_ptr<DiskStore> image, const std::string& journalPath);
+
+    ~JournaledDiskStore() override;
+
+    size_t read(size_t offset, uint8_t* buffer, size_t count) override;
+    size_t write(size_t offset, const uint8_t* buffer, size_t count) override;
+    void flush() override;     // Commit
+    void sync() override;      // Checkpoint, so the image file is complete
+    void commit() override;
+    size_t size() const override { return m_image->size(); }
+
+private:
+    JournaledDiskStore() = default;
+
+    // Hand each committed write in the journal at path to apply, in order;
+    // false if a write could not be applied
+    using ReplayFunction = std::function<bool(uint64_t offset, const uint8_t* data, size_t length)>;
+    static bool replay(const std::string& journalPath, const ReplayFunction& apply, bool& applied);
+
+    bool resetJournal();
+    void checkpoint();
+    bool writeRecord(uint8_t type, uint64_t offset, const uint8_t* data, uint32_t length);
+    void writeOverlay(size_t offset, const uint8_t* buffer, size_t count);
+
+    std::unique_ptr<DiskStore> m_image;
+    std::string m_journalPath;
+    FILE* m_journal = nullptr;     // nullptr: read-only replay (openReadOnly)
+    uint64_t m_journalSize = 0;
+    uint32_t m_seq = 1;
+    bool m_txnOpen = false;    // Writes since the last commit record
+
+    // Sectors written since the last checkpoint
+    std::unordered_map<uint64_t, std::vector<uint8_t>> m_overlay;
+};
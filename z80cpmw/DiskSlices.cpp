@@ -0,0 +1,141 @@
+/*
+ * DiskSlices.cpp - Lazy Per-Slice Disk Image Loading Implementation
+ */
+
+#include "pch.h"
+#include "DiskSlices.h"
+#include <map>
+
+// Open sliced stores by path, so the UI can read counters without reaching
+// into the emu_disk handles owned by HBIOS
+static std::mutex g_registryMutex;
+static std::map<std::string, SlicedDiskStore*> g_registry;
+
+SlicedDiskStore::SlicedDiskStore(std::unique_ptr<DiskStore> image, const std::string& path, bool cacheSlices)
+    : m_image(std::move(image)), m_path(path), m_cacheSlices(cacheSlices)
+{
+    size_t imageSize = m_image->size();
+    if (imageSize % SLICE_SIZE == PREFIX_SIZE) {
+        m_prefixSize = PREFIX_SIZE;
+    }
+
+    m_sliceCount = (m_prefixSize ? 1 : 0) + (imageSize - m_prefixSize + SLICE_SIZE - 1) / SLICE_SIZE;
+    m_slices.reset(new Slice[m_sliceCount]);
+
+    size_t start = 0;
+    for (size_t i = 0; i < m_sliceCount; i++) {
+        size_t length = (i == 0 && m_prefixSize) ? m_prefixSize : SLICE_SIZE;
+        m_slices[i].start = start;
+        m_slices[i].size = std::min(length, imageSize - start);
+        start += m_slices[i].size;
+    }
+
+    // The attached unit registers first; later opens of the same file (an
+    // export, say) don't replace it
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_registry.emplace(m_path, this);
+}
+
+SlicedDiskStore::~SlicedDiskStore() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_registry.find(m_path);
+    if (it != g_registry.end() && it->second == this) {
+        g_registry.erase(it);
+    }
+}
+
+size_t SlicedDiskStore::sliceIndex(size_t offset) const {
+    if (offset < m_prefixSize) return 0;
+    return (m_prefixSize ? 1 : 0) + (offset - m_prefixSize) / SLICE_SIZE;
+}
+
+bool SlicedDiskStore::materialize(Slice& slice) {
+    if (slice.resident) return true;
+
+    slice.data.resize(slice.size);
+    size_t got = m_image->read(slice.start, slice.data.data(), slice.size);
+    slice.hostBytesRead += got;
+    if (got != slice.size) {
+        slice.data.clear();
+        slice.data.shrink_to_fit();
+        return false;
+    }
+    slice.resident = true;
+    return true;
+}
+
+size_t SlicedDiskStore::read(size_t offset, uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        Slice& slice = m_slices[sliceIndex(pos)];
+        size_t within = pos - slice.start;
+        size_t chunk = std::min(count - done, slice.size - within);
+        slice.reads++;
+
+        if (m_cacheSlices) {
+            if (!materialize(slice)) break;
+            memcpy(buffer + done, slice.data.data() + within, chunk);
+        } else {
+            size_t got = m_image->read(pos, buffer + done, chunk);
+            slice.hostBytesRead += got;
+            if (got != chunk) break;
+        }
+        done += chunk;
+    }
+    return done;
+}
+
+size_t SlicedDiskStore::write(size_t offset, const uint8_t* buffer, size_t count) {
+    size_t imageSize = size();
+    if (offset >= imageSize) return 0;
+    count = std::min(count, imageSize - offset);
+
+    size_t done = 0;
+    while (done < count) {
+        size_t pos = offset + done;
+        Slice& slice = m_slices[sliceIndex(pos)];
+        size_t within = pos - slice.start;
+        size_t chunk = std::min(count - done, slice.size - within);
+        slice.writes++;
+
+        // Write through; a slice that isn't resident yet doesn't need loading
+        size_t put = m_image->write(pos, buffer + done, chunk);
+        slice.hostBytesWritten += put;
+        if (slice.resident) {
+            memcpy(slice.data.data() + within, buffer + done, put);
+        }
+        done += put;
+        if (put != chunk) break;
+    }
+    return done;
+}
+
+std::vector<DiskSliceStats> SlicedDiskStore::stats() const {
+    std::vector<DiskSliceStats> result(m_sliceCount);
+    for (size_t i = 0; i < m_sliceCount; i++) {
+        const Slice& slice = m_slices[i];
+        DiskSliceStats& s = result[i];
+        s.start = slice.start;
+        s.size = slice.size;
+        s.prefix = (i == 0 && m_prefixSize);
+        s.resident = slice.resident;
+        s.reads = slice.reads;
+        s.writes = slice.writes;
+        s.hostBytesRead = slice.hostBytesRead;
+        s.hostBytesWritten = slice.hostBytesWritten;
+    }
+    return result;
+}
+
+bool getDiskSliceStats(const std::string& path, std::vector<DiskSliceStats>& stats) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_registry.find(path);
+    if (it == g_registry.end()) return false;
+    stats = it->second->stats();
+    return true;
+}
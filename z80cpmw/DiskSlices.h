@@ -0,0 +1,72 @@
+/*
+ * DiskSlices.h - Lazy Per-Slice Disk Image Loading
+ *
+ * hd1k images are made of 8 MB slices (combo disks add a 1 MB partition
+ * prefix), and a guest usually only touches one or two of them. Instead of
+ * reading the whole image up front, a SlicedDiskStore materializes each slice
+ * in memory the first time the guest accesses it and writes through to the
+ * image file. Per-slice residency and I/O counters are kept for the UI.
+ */
+
+#pragma once
+
+#include "DiskStore.h"
+#include <atomic>
+#include <vector>
+
+// Snapshot of one slice's counters
+struct DiskSliceStats {
+    size_t start = 0;           // Byte offset in the image
+    size_t size = 0;
+    bool prefix = false;        // Combo disk partition prefix, not a CP/M slice
+    bool resident = false;      // Materialized in memory
+    uint64_t reads = 0;         // Guest read/write calls touching the slice
+    uint64_t writes = 0;
+    uint64_t hostBytesRead = 0; // Bytes moved to/from the image file
+    uint64_t hostBytesWritten = 0;
+};
+
+class SlicedDiskStore : public DiskStore {
+public:
+    static constexpr size_t SLICE_SIZE = 8 * 1024 * 1024;
+    static constexpr size_t PREFIX_SIZE = 1024 * 1024;
+
+    // cacheSlices materializes slices in memory; otherwise I/O passes through
+    // (block-addressed formats) and only the counters are kept
+    SlicedDiskStore(std::unique_ptr<DiskStore> image, const std::string& path, bool cacheSlices);
+    ~SlicedDiskStore() override;
+
+    size_t read(size_t offset, uint8_t* buffer, size_t count) override;
+    size_t write(size_t offset, const uint8_t* buffer, size_t count) override;
+    void flush() override { m_image->flush(); }
+    void sync() override { m_image->sync(); }
+    void commit() override { m_image->commit(); }
+    size_t size() const override { return m_image->size(); }
+
+    std::vector<DiskSliceStats> stats() const;
+
+private:
+    struct Slice {
+        size_t start = 0;
+        size_t size = 0;
+        std::vector<uint8_t> data;  // Empty until materialized
+        std::atomic<bool> resident{false};
+        std::atomic<uint64_t> reads{0};
+        std::atomic<uint64_t> writes{0};
+        std::atomic<uint64_t> hostBytesRead{0};
+        std::atomic<uint64_t> hostBytesWritten{0};
+    };
+
+    size_t sliceIndex(size_t offset) const;
+    bool materialize(Slice& slice);
+
+    std::unique_ptr<DiskStore> m_image;
+    std::string m_path;
+    bool m_cacheSlices;
+    size_t m_prefixSize = 0;
+    std::unique_ptr<Slice[]> m_slices;
+    size_t m_sliceCount = 0;
+};
+
+// Counters for the open image at path (false if it isn't open)
+bool getDiskSliceStats(const std::string& path, std::vector<DiskSliceStats>& stats);
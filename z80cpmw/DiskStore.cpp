@@ -0,0 +1,178 @@
+/*
+ * DiskStore.cpp - Disk Image Backing Stores Implementation
+ */
+
+#include "pch.h"
+#include "DiskStore.h"
+#include "DiskContainer.h"
+#include "BlockStore.h"
+#include "DiskJournal.h"
+#include "DiskSlices.h"
+#include <io.h>
+
+static bool g_journaling = false;
+
+RawDiskStore::RawDiskStore(FILE* fp)
+    : m_fp(fp)
+{
+    _fseeki64(m_fp, 0, SEEK_END);
+    m_size = (size_t)_ftelli64(m_fp);
+}
+
+RawDiskStore::~RawDiskStore() {
+    if (m_fp) fclose(m_fp);
+}
+
+size_t RawDiskStore::read(size_t offset, uint8_t* buffer, size_t count) {
+    _fseeki64(m_fp, (long long)offset, SEEK_SET);
+    return fread(buffer, 1, count, m_fp);
+}
+
+size_t RawDiskStore::write(size_t offset, const uint8_t* buffer, size_t count) {
+    _fseeki64(m_fp, (long long)offset, SEEK_SET);
+    size_t written = fwrite(buffer, 1, count, m_fp);
+
+    size_t newEnd = offset + written;
+    if (newEnd > m_size) {
+        m_size = newEnd;
+    }
+    return written;
+}
+
+void RawDiskStore::flush() {
+    fflush(m_fp);
+}
+
+void RawDiskStore::sync() {
+    fflush(m_fp);
+    _commit(_fileno(m_fp));
+}
+
+void setDiskJournaling(bool enable) {
+    g_journaling = enable;
+}
+
+static std::unique_ptr<DiskStore> openImageStore(const std::string& path, const char* mode) {
+    bool writable;
+    bool create = false;
+    if (strcmp(mode, "r") == 0) {
+        writable = false;
+    } else if (strcmp(mode, "rw") == 0) {
+        writable = true;
+    } else if (strcmp(mode, "rw+") == 0) {
+        writable = true;
+        create = true;
+    } else {
+        return nullptr;
+    }
+
+    // Compressed containers are recognised by their header, not the extension
+    if (DiskContainer::isContainer(path)) {
+        return DiskContainer::open(path, writable);
+    }
+    if (BlockStore::isImage(path)) {
+        return DedupDiskStore::open(path, writable);
+    }
+
+    FILE* f = fopen(path.c_str(), writable ? "r+b" : "rb");
+    if (!f && create) {
+        f = fopen(path.c_str(), "w+b");
+    }
+    if (!f) return nullptr;
+
+    return std::make_unique<RawDiskStore>(f);
+}
+
+std::unique_ptr<DiskStore> openDiskStore(const std::string& path, const char* mode) {
+    std::unique_ptr<DiskStore> store = openImageStore(path, mode);
+    if (!store) return nullptr;
+
+    // Raw images are materialized a slice at a time; block formats are
+    // already lazy and only get the per-slice counters. A read-only open
+    // (an export) streams straight through rather than keep every slice.
+    bool readOnly = strcmp(mode, "r") == 0;
+    if (store->size() > 0) {
+        bool raw = dynamic_cast<RawDiskStore*>(store.get()) != nullptr;
+        store = std::make_unique<SlicedDiskStore>(std::move(store), path, raw && !readOnly);
+    }
+    // A read-only open still sees committed writes from a leftover journal
+    std::string journalPath = path + ".wal";
+    if (readOnly) {
+        return JournaledDiskStore::openReadOnly(std::move(store), journalPath);
+    }
+
+    if (g_journaling) {
+        return JournaledDiskStore::open(std::move(store), journalPath);
+    }
+    if (!JournaledDiskStore::recover(*store, journalPath)) return nullptr;
+    return store;
+}
+
+bool isStoreBackedImage(const std::string& path) {
+    return DiskContainer::isContainer(path) || BlockStore::isImage(path);
+}
+
+bool exportRawImage(const std::string& sourcePath, const std::string& rawPath,
+                    std::function<void(size_t done, size_t total)> progress) {
+    // Never truncate the source, however its path is spelled
+    if (isSameFile(sourcePath, rawPath)) return false;
+
+    auto store = openDiskStore(sourcePath, "r");
+    if (!store) return false;
+
+    // Write to a temp file and swap it in, so a failed export leaves any
+    // existing file at rawPath as it was
+    std::string tempPath = rawPath + ".tmp";
+    FILE* out = fopen(tempPath.c_str(), "wb");
+    if (!out) return false;
+
+    const size_t CHUNK = 64 * 1024;
+    std::vector<uint8_t> buffer(CHUNK);
+    size_t total = store->size();
+    size_t done = 0;
+    bool ok = true;
+    while (done < total && ok) {
+        size_t want = std::min(CHUNK, total - done);
+        ok = store->read(done, buffer.data(), want) == want &&
+             fwrite(buffer.data(), 1, want, out) == want;
+        done += want;
+        if (progress) progress(done, total);
+    }
+
+    if (fclose(out) != 0) ok = false;
+    store.reset();
+    if (ok) {
+        ok = MoveFileExA(tempPath.c_str(), rawPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+    if (!ok) {
+        DeleteFileA(tempPath.c_str());
+    }
+    return ok;
+}
+
+bool isSameFile(const std::string& a, const std::string& b) {
+    // File IDs see through case, 8.3 short names, separators and links
+    auto identify = [](const std::string& path, BY_HANDLE_FILE_INFORMATION& info) {
+        HANDLE h = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, 0, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return false;
+        bool ok = GetFileInformationByHandle(h, &info) != 0;
+        CloseHandle(h);
+        return ok;
+    };
+    BY_HANDLE_FILE_INFORMATION infoA, infoB;
+    if (identify(a, infoA) && identify(b, infoB)) {
+        return infoA.dwVolumeSerialNumber == infoB.dwVolumeSerialNumber &&
+               infoA.nFileIndexHigh == infoB.nFileIndexHigh &&
+               infoA.nFileIndexLow == infoB.nFileIndexLow;
+    }
+
+    // A file that can't be opened (or doesn't exist yet) falls back to
+    // comparing the full paths, which Windows treats case-insensitively
+    char fullA[MAX_PATH], fullB[MAX_PATH];
+    if (!GetFullPathNameA(a.c_str(), MAX_PATH, fullA, nullptr) ||
+        !GetFullPathNameA(b.c_str(), MAX_PATH, fullB, nullptr)) {
+        return false;
+    }
+    return _stricmp(fullA, fullB) == 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * DiskStore.h - Disk Image Backing Stores
+ *
+ * Abstracts the storage behind an emu_disk_handle so HBIOS sector I/O can be
+ * served from a plain .img file or from one of the container formats.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+
+class DiskStore {
+public:
+    virtual ~DiskStore() = default;
+
+    // Transfer bytes at a byte offset into the logical (uncompressed) image.
+    // Return the number of bytes actually transferred.
+    virtual size_t read(size_t offset, uint8_t* buffer, size_t count) = 0;
+    virtual size_t write(size_t offset, const uint8_t* buffer, size_t count) = 0;
+
+    // Commit buffered writes to the host file
+    virtual void flush() = 0;
+
+    // flush() and force the host file to stable storage
+    virtual void sync() { flush(); }
+
+    // Close the current write transaction (journaled stores only)
+    virtual void commit() {}
+
+    // Logical image size in bytes
+    virtual size_t size() const = 0;
+};
+
+// Plain sector-for-sector image file
+class RawDiskStore : public DiskStore {
+public:
+    explicit RawDiskStore(FILE* fp);
+    ~RawDiskStore() override;
+
+    size_t read(size_t offset, uint8_t* buffer, size_t count) override;
+    size_t write(size_t offset, const uint8_t* buffer, size_t count) override;
+    void flush() override;
+    void sync() override;
+    size_t size() const override { return m_size; }
+
+private:
+    FILE* m_fp;
+    size_t m_size = 0;
+};
+
+// Open the store for an image file, picking the format from its header.
+// mode is "r", "rw" or "rw+" (create if missing) as for emu_disk_open().
+// Images are wrapped for lazy per-slice access (DiskSlices.h). Writable
+// stores are journaled when journaling is on; a journal left by a crash is
+// always recovered.
+std::unique_ptr<DiskStore> openDiskStore(const std::string& path, const char* mode);
+
+// Journal writes to images opened from now on (see DiskJournal.h)
+void setDiskJournaling(bool enable);
+
+// True for formats that must stay attached through their store (containers,
+// deduplicated images) rather than being loaded into memory as raw sectors
+bool isStoreBackedImage(const std::string& path);
+
+// Write any supported image out as a raw sector-for-sector .img. The copy
+// goes to rawPath + ".tmp" and replaces rawPath only once complete; an
+// export onto the source itself is refused.
+bool exportRawImage(const std::string& sourcePath, const std::string& rawPath,
+                    std::function<void(size_t done, size_t total)> progress = nullptr);
+
+// True if both paths name the same file, whatever the spelling (case,
+// short names, '/' or '\' separators)
+bool isSameFile(const std::string& a, const std::string& b);
@@ -12,34 +12,36 @@
 #include "emu_io.h"
 #include "emu_init.h"
 #include "Dazzler.h"
+#include "DiskStore.h"
 
 // External callback setters from emu_io_windows.cpp
 extern "C" {
-    void emu_io_set_output_callback(void(*cb)(uint8_t));
     void emu_io_set_video_callback(void(*cb)(int, int, int, uint8_t));
     void emu_io_set_beep_callback(void(*cb)(int));
-}
-
-// Global engine pointer for callbacks (single instance)
-static EmulatorEngine* g_engine = nullptr;
-
-// Output callback wrapper - routes emu_console_write_char to the engine callback
-static void outputCallbackWrapper(uint8_t ch) {
-    if (g_engine && g_engine->getOutputCallback()) {
-        g_engine->getOutputCallback()(ch);
-    }
+    void emu_disk_commit_all();
+    void emu_disk_sync_all();
+    void emu_console_write_block(const uint8_t* data, size_t count);
+    size_t emu_console_output_peek(const uint8_t** data);
+    void emu_console_output_consume(size_t count);
+    size_t emu_console_output_space();
+    size_t emu_console_queue_chars(const uint8_t* data, size_t count);
+    bool emu_console_wait_input(int timeoutMs);
+    void emu_console_wake();
+    void emu_video_set_text_size(int rows, int cols);
+    int emu_host_stream_open(const char* filename, bool write);
+    size_t emu_host_stream_read_block(int handle, uint8_t* data, size_t count);
+    bool emu_host_stream_write_block(int handle, const uint8_t* data, size_t count);
+    bool emu_host_stream_close(int handle);
+    void emu_host_stream_reset();
 }
 
 EmulatorEngine::EmulatorEngine() {
-    g_engine = this;
     initCPU();
     emu_io_init();
-    emu_io_set_output_callback(outputCallbackWrapper);
 }
 
 EmulatorEngine::~EmulatorEngine() {
     stop();
-    g_engine = nullptr;
     emu_io_cleanup();
 }
 
@@ -102,6 +104,7 @@ bool EmulatorEngine::loadROM(const std::string& path) {
 
 bool EmulatorEngine::loadROMFromData(const uint8_t* data, size_t size) {
     if (!m_memory || !data || size == 0) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
 
     // Reset RAM bank initialization tracking
     *m_hbios->getInitializedBanksBitmap() = 0;
@@ -117,10 +120,26 @@ bool EmulatorEngine::loadROMFromData(const uint8_t* data, size_t size) {
 
 bool EmulatorEngine::loadDisk(int unit, const std::string& path) {
     if (unit < 0 || unit >= 4) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Images stay on disk and HBIOS sector I/O goes through emu_disk_*:
+    // raw images are read a slice at a time on first access, containers and
+    // deduplicated images only fetch the block touched, and journaled
+    // writes go to the .wal
+    if (m_hbios->loadDiskFromFile(unit, path)) {
+        std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
+        m_diskPaths[unit] = path;
+        m_diskFileBacked[unit] = true;
+        return true;
+    }
+    if (isStoreBackedImage(path)) return false;
+
     std::vector<uint8_t> data;
     if (!emu_file_load(path, data)) return false;
     if (m_hbios->loadDisk(unit, data.data(), data.size())) {
+        std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
         m_diskPaths[unit] = path;
+        m_diskFileBacked[unit] = false;
         return true;
     }
     return false;
@@ -128,35 +147,97 @@ bool EmulatorEngine::loadDisk(int unit, const std::string& path) {
 
 bool EmulatorEngine::loadDiskFromData(int unit, const uint8_t* data, size_t size) {
     if (unit < 0 || unit >= 4) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    {
+        std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
+        m_diskFileBacked[unit] = false;
+    }
     return m_hbios->loadDisk(unit, data, size);
 }
 
 void EmulatorEngine::closeDisk(int unit) {
     if (unit < 0 || unit >= 4) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_hbios->closeDisk(unit);
+    std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
     m_diskPaths[unit].clear();
+    m_diskFileBacked[unit] = false;
 }
 
-bool EmulatorEngine::saveDisk(int unit, const std::string& path) {
+bool EmulatorEngine::saveDisk(int unit, const std::string& path, DiskProgressCallback progress) {
     if (unit < 0 || unit >= 4) return false;
-    auto data = getDiskData(unit);
-    if (data.empty()) return false;
-    return emu_file_save(path, data);
+
+    // Holding the engine lock keeps the guest from writing the image (and
+    // the unit from being reloaded) while it is streamed out
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A file-backed unit's image is open for the guest, so no save may land
+    // on it (or on any other unit's image) under any spelling of its path
+    for (int other = 0; other < 4; other++) {
+        if (m_diskPaths[other].empty() || !m_hbios->isDiskLoaded(other)) continue;
+        if (!isSameFile(path, m_diskPaths[other])) continue;
+        if (other != unit) return false;
+        if (m_diskFileBacked[unit]) {
+            // Written through as it goes; just checkpoint it
+            m_hbios->flushAllDisks();
+            return true;
+        }
+    }
+
+    if (m_diskFileBacked[unit]) {
+        // File-backed units are written through to their file as they go;
+        // saving elsewhere writes a raw copy of the (checkpointed) image
+        m_hbios->flushAllDisks();
+        emu_disk_sync_all();
+        return exportRawImage(m_diskPaths[unit], path, progress);
+    }
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!getDiskView(unit, &data, &size) || size == 0) return false;
+
+    // Write to a temp file and swap it in so saving over the image the
+    // unit was loaded from never leaves a truncated file behind
+    std::string tempPath = path + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) return false;
+
+    const size_t CHUNK = 1024 * 1024;
+    size_t done = 0;
+    while (done < size) {
+        size_t chunk = std::min(CHUNK, size - done);
+        if (fwrite(data + done, 1, chunk, f) != chunk) break;
+        done += chunk;
+        if (progress) progress(done, size);
+    }
+
+    bool ok = fclose(f) == 0 && done == size;
+    if (ok) {
+        ok = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+    if (!ok) {
+        DeleteFileA(tempPath.c_str());
+    }
+    return ok;
 }
 
-std::vector<uint8_t> EmulatorEngine::getDiskData(int unit) {
-    if (unit < 0 || unit >= 4) return {};
+bool EmulatorEngine::getDiskView(int unit, const uint8_t** data, size_t* size) {
+    if (unit < 0 || unit >= 4 || m_diskFileBacked[unit]) return false;
     const auto& disk = m_hbios->getDisk(unit);
-    if (!disk.is_open) return {};
-    return disk.data;
+    if (!disk.is_open) return false;
+    *data = disk.data.data();
+    *size = disk.data.size();
+    return true;
 }
 
 bool EmulatorEngine::isDiskLoaded(int unit) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (unit < 0 || unit >= 4) return false;
     return m_hbios->isDiskLoaded(unit);
 }
 
 void EmulatorEngine::setDiskPath(int unit, const std::string& path) {
+    std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
     if (unit >= 0 && unit < 4) m_diskPaths[unit] = path;
 }
 
@@ -166,29 +247,50 @@ const std::string& EmulatorEngine::getDiskPath(int unit) const {
     return m_diskPaths[unit];
 }
 
+std::vector<DiskSliceStats> EmulatorEngine::getDiskSliceStats(int unit) const {
+    std::vector<DiskSliceStats> stats;
+    if (unit < 0 || unit >= 4) return stats;
+
+    // UI timer: snapshot the path under the path lock only, since a save
+    // can hold m_mutex for as long as the export takes
+    std::string path;
+    {
+        std::lock_guard<std::mutex> pathLock(m_diskPathMutex);
+        if (!m_diskFileBacked[unit]) return stats;
+        path = m_diskPaths[unit];
+    }
+    ::getDiskSliceStats(path, stats);
+    return stats;
+}
+
 void EmulatorEngine::setDiskSliceCount(int unit, int slices) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (unit >= 0 && unit < 4 && m_hbios) {
         m_hbios->setDiskSliceCount(unit, slices);
     }
 }
 
 void EmulatorEngine::setDiskIsManifest(int unit, bool isManifest) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_hbios) {
         m_hbios->setDiskIsManifest(unit, isManifest);
     }
 }
 
 void EmulatorEngine::setDiskWarningSuppressed(int unit, bool suppressed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_hbios) {
         m_hbios->setDiskWarningSuppressed(unit, suppressed);
     }
 }
 
 bool EmulatorEngine::pollManifestWriteWarning() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_hbios ? m_hbios->pollManifestWriteWarning() : false;
 }
 
 void EmulatorEngine::flushAllDisks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_hbios) {
         m_hbios->flushAllDisks();
     }
@@ -227,6 +329,8 @@ void EmulatorEngine::start() {
     // Configure boot option via NVRAM switches (not character queueing)
     // Empty string = show boot menu, "0" = disk unit 0, "C" = ROM app C, etc.
     m_hbios->setNvramSetting(m_bootString);
+
+    m_thread = std::thread(&EmulatorEngine::emulatorThread, this);
     sendStatus("Running");
 }
 
@@ -234,6 +338,10 @@ void EmulatorEngine::stop() {
     if (!m_running) return;
     m_stopRequested = true;
     m_running = false;
+    emu_console_wake();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
     sendStatus("Stopped");
 }
 
@@ -248,21 +356,22 @@ void EmulatorEngine::reset() {
     *m_hbios->getInitializedBanksBitmap() = 0;
     emu_console_clear_queue();
     m_hbios->reset();
-    m_escapeState = EscapeState::Normal;
-    m_escapeParams.clear();
-    m_escapeCurrentParam.clear();
+    emu_host_stream_reset();
     m_instructionCount = 0;
+    m_clockTicks = 0;
+    m_nextFrame = 0;
     if (wasRunning) start();
     sendStatus("Reset");
 }
 
 void EmulatorEngine::sendChar(char ch) { emu_console_queue_char(ch); }
 
-void EmulatorEngine::sendString(const std::string& str) {
-    for (char c : str) emu_console_queue_char(c);
+size_t EmulatorEngine::sendString(const std::string& str) {
+    return emu_console_queue_chars((const uint8_t*)str.data(), str.size());
 }
 
 void EmulatorEngine::clearNvramSetting() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_hbios) {
         m_hbios->setNvramSetting("");
     }
@@ -270,53 +379,186 @@ void EmulatorEngine::clearNvramSetting() {
 }
 
 bool EmulatorEngine::hasNvramChange() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_hbios ? m_hbios->hasNvramChange() : false;
 }
 
 std::string EmulatorEngine::getNvramSetting() {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_hbios ? m_hbios->getNvramSetting() : "";
 }
 
+void EmulatorEngine::setJournalDiskWrites(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_journalDiskWrites = enable;
+    setDiskJournaling(enable);
+}
+
 void EmulatorEngine::setDebug(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_debug = enable;
     if (m_hbios) m_hbios->setDebug(enable);
 }
 
+void EmulatorEngine::setTextSize(int rows, int cols) {
+    emu_video_set_text_size(rows, cols);
+}
+
 uint16_t EmulatorEngine::getProgramCounter() const {
     return m_cpu ? m_cpu->regs.PC.get_pair16() : 0;
 }
 
 uint64_t EmulatorEngine::getInstructionCount() const { return m_instructionCount; }
 
-void EmulatorEngine::runBatch() {
-    if (!m_running) return;
+void EmulatorEngine::emulatorThread() {
+    // Same pace the UI timer used to give: one batch per interval
+    auto nextBatch = std::chrono::steady_clock::now();
+    while (!m_stopRequested) {
+        // Backpressure: during an output flood the guest waits for the
+        // terminal to catch up instead of output being dropped
+        if (emu_console_output_space() < OUTPUT_HEADROOM) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            nextBatch = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        bool waitingForInput = runBatch();
+
+        nextBatch += BATCH_INTERVAL;
+        auto now = std::chrono::steady_clock::now();
+        if (nextBatch <= now) {
+            nextBatch = now;  // Fell behind; don't try to catch up
+            continue;
+        }
+
+        if (waitingForInput) {
+            // Idle until a key arrives; the key ends the wait at once
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextBatch - now);
+            if (emu_console_wait_input((int)wait.count())) {
+                nextBatch = std::chrono::steady_clock::now();
+            }
+        } else {
+            std::this_thread::sleep_until(nextBatch);
+        }
+    }
+}
+
+bool EmulatorEngine::runBatch() {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (int i = 0; i < BATCH_SIZE && m_running && !m_stopRequested; i++) {
+    uint64_t executed = 0;
+    for (int i = 0; i < BATCH_SIZE && !m_stopRequested; i++) {
         m_cpu->execute();
-        m_instructionCount++;
+        m_clockTicks += NOMINAL_TICKS_PER_INSTRUCTION;
+        executed++;
+    }
+    m_instructionCount += executed;
+
+    // Display devices present at most once per emulated frame (a batch is
+    // shorter than a frame, so no boundary is ever skipped twice over)
+    if (m_clockTicks >= m_nextFrame) {
+        m_nextFrame = (m_clockTicks / FRAME_TICKS + 1) * FRAME_TICKS;
+        for (auto& dazzler : m_dazzlers) {
+            dazzler->endFrame();
+        }
     }
-    if (m_hbios->isWaitingForInput() && emu_console_has_input()) {
+
+    bool waitingForInput = m_hbios->isWaitingForInput();
+    if (waitingForInput && emu_console_has_input()) {
         m_hbios->clearWaitingForInput();
+        waitingForInput = false;
     }
-}
 
-void EmulatorEngine::flushOutput() {
-    if (!m_hbios || !m_outputCallback) return;
+    // Output HBIOS buffered during the batch joins the console ring
     std::vector<uint8_t> chars = m_hbios->getOutputChars();
-    for (uint8_t ch : chars) {
-        m_outputCallback(ch);
+    if (!chars.empty()) {
+        emu_console_write_block(chars.data(), chars.size());
+    }
+
+    // Group commit: all sector writes since the last interval share one sync
+    if (m_journalDiskWrites) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastJournalCommit >= JOURNAL_COMMIT_INTERVAL) {
+            m_lastJournalCommit = now;
+            emu_disk_commit_all();
+        }
     }
+    return waitingForInput;
+}
+
+size_t EmulatorEngine::flushOutput() {
+    // Hand the ring's contents over in place, at most two spans (wrap point)
+    const uint8_t* data;
+    size_t count;
+    size_t total = 0;
+    while ((count = emu_console_output_peek(&data)) > 0) {
+        if (m_outputCallback) m_outputCallback(data, count);
+        emu_console_output_consume(count);
+        total += count;
+    }
+    return total;
 }
 
 void EmulatorEngine::handleHBIOS() { m_hbios->handlePortDispatch(); }
 
-void EmulatorEngine::sendStatus(const std::string& status) {
-    if (m_statusCallback) m_statusCallback(status);
+void EmulatorEngine::handleHostStream() {
+    auto& regs = m_cpu->regs;
+    uint8_t function = regs.BC.get_high();
+    int handle = regs.BC.get_low();
+    uint16_t addr = regs.DE.get_pair16();
+    size_t count = regs.HL.get_pair16();
+    uint8_t result = 0xFF;
+
+    // Guest memory goes through the bank mapping (and the Dazzler write
+    // watch) like CPU accesses; the buffer wraps at 64K as LDIR would
+    switch (function) {
+    case H_READ_BLOCK: {
+        m_hostBlock.resize(count);
+        size_t moved = emu_host_stream_read_block(handle, m_hostBlock.data(), count);
+        for (size_t i = 0; i < moved; i++) {
+            m_memory->store_mem((uint16_t)(addr + i), m_hostBlock[i]);
+        }
+        regs.HL.set_pair16((uint16_t)moved);
+        if (moved > 0 || count == 0) result = 0;
+        break;
+    }
+    case H_WRITE_BLOCK: {
+        m_hostBlock.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            m_hostBlock[i] = m_memory->fetch_mem((uint16_t)(addr + i));
+        }
+        bool ok = emu_host_stream_write_block(handle, m_hostBlock.data(), count);
+        regs.HL.set_pair16(ok ? (uint16_t)count : 0);
+        if (ok) result = 0;
+        break;
+    }
+    case H_HOPEN_R:
+    case H_HOPEN_W: {
+        std::string name;
+        for (size_t i = 0; i < HOST_FILENAME_MAX; i++) {
+            uint8_t ch = m_memory->fetch_mem((uint16_t)(addr + i));
+            if (ch == 0) break;
+            name += (char)ch;
+        }
+        int opened = emu_host_stream_open(name.c_str(), function == H_HOPEN_W);
+        if (opened >= 0) result = (uint8_t)opened;
+        break;
+    }
+    case H_HCLOSE:
+        if (emu_host_stream_close(handle)) result = 0;
+        break;
+    default:
+        if (m_debug) {
+            emu_log("[EMU] Unknown host stream function 0x%02X\n", function);
+        }
+        break;
+    }
+
+    regs.AF.set_high(result);
 }
 
-void EmulatorEngine::processChar(uint8_t ch) {
-    if (m_outputCallback) m_outputCallback(ch);
+void EmulatorEngine::sendStatus(const std::string& status) {
+    if (m_statusCallback) m_statusCallback(status);
 }
 
 std::string EmulatorEngine::getAppDirectory() {
@@ -355,56 +597,158 @@ std::string EmulatorEngine::getUserDataDirectory() {
     return userDir;
 }
 
-void EmulatorEngine::enableDazzler(uint8_t basePort, int scale) {
-    if (m_dazzler) return;  // Already enabled
+Dazzler* EmulatorEngine::enableDazzler(uint8_t basePort, int scale) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Dazzler* existing = getDazzler(basePort)) {
+        return existing;  // Already enabled
+    }
+    if (basePort == 0xFF || m_dazzlerPorts[basePort] || m_dazzlerPorts[basePort + 1] ||
+        basePort == HOST_STREAM_PORT || basePort + 1 == HOST_STREAM_PORT ||
+        (int)m_dazzlers.size() >= MAX_DAZZLERS) {
+        return nullptr;
+    }
 
-    m_dazzler = std::make_unique<Dazzler>(basePort);
-    m_dazzler->setScale(scale);
+    auto dazzler = std::make_unique<Dazzler>(basePort);
+    dazzler->setScale(scale);
+
+    // Status port timing follows the approximate emulated clock
+    dazzler->setClock([this] { return m_clockTicks; }, NOMINAL_CLOCK_HZ);
 
     // Set memory read callback for Dazzler to read framebuffer
     // This properly handles banked memory (lower 32K from current bank, upper 32K from common)
     if (m_memory) {
-        m_dazzler->setMemoryReadCallback([this](uint16_t addr) -> uint8_t {
+        dazzler->setMemoryReadCallback([this](uint16_t addr) -> uint8_t {
             return m_memory->fetch_mem(addr);
         });
 
-        // Set up memory write callback for framebuffer updates
-        m_memory->set_write_callback([this](uint16_t addr, uint8_t value) {
-            if (m_dazzler) {
-                m_dazzler->onMemoryWrite(addr, value);
+        // Rendering copies the whole picture in one call
+        dazzler->setMemoryBlockReadCallback([this](uint16_t addr, uint8_t* dest, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                dest[i] = m_memory->fetch_mem((uint16_t)(addr + i));
             }
         });
+
+        // One write callback serves every card; stores outside all
+        // pictures stop at the page lookup
+        if (m_dazzlers.empty()) {
+            m_memory->set_write_callback([this](uint16_t addr, uint8_t value) {
+                uint8_t watchers = m_dazzlerPageWatch[addr >> 8];
+                for (int i = 0; watchers; i++, watchers >>= 1) {
+                    if (watchers & 1) {
+                        m_dazzlers[i]->onMemoryWrite(addr, value);
+                    }
+                }
+            });
+        }
     }
+
+    Dazzler* result = dazzler.get();
+    m_dazzlers.push_back(std::move(dazzler));
+    rebuildDazzlerMaps();
+    return result;
 }
 
-void EmulatorEngine::disableDazzler() {
-    if (!m_dazzler) return;
+void EmulatorEngine::disableDazzler(uint8_t basePort) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_dazzlers.size(); i++) {
+        if (m_dazzlers[i]->getBasePort() == basePort) {
+            m_dazzlers.erase(m_dazzlers.begin() + i);
+            break;
+        }
+    }
 
-    // Clear memory write callback
-    if (m_memory) {
+    // Clear memory write callback with the last card
+    if (m_dazzlers.empty() && m_memory) {
         m_memory->set_write_callback(nullptr);
     }
+    rebuildDazzlerMaps();
+}
 
-    m_dazzler.reset();
+void EmulatorEngine::disableAllDazzlers() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_memory && !m_dazzlers.empty()) {
+        m_memory->set_write_callback(nullptr);
+    }
+    m_dazzlers.clear();
+    rebuildDazzlerMaps();
+}
+
+Dazzler* EmulatorEngine::getDazzler(uint8_t basePort) {
+    Dazzler* dazzler = m_dazzlerPorts[basePort];
+    return (dazzler && dazzler->getBasePort() == basePort) ? dazzler : nullptr;
+}
+
+void EmulatorEngine::setDazzlerUpdateHandler(Dazzler* dazzler, DazzlerUpdateHandler handler) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& card : m_dazzlers) {
+        if (card.get() == dazzler) {
+            card->setUpdateCallback(handler);
+            break;
+        }
+    }
+}
+
+void EmulatorEngine::setDazzlerFrameHandler(DazzlerFrameHandler handler) {
+    // The lock keeps endFrame() from running while the handler changes
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dazzlerFrameHandler = handler;
+    rebuildDazzlerMaps();
+}
+
+void EmulatorEngine::rebuildDazzlerMaps() {
+    std::fill(std::begin(m_dazzlerPorts), std::end(m_dazzlerPorts), nullptr);
+    for (size_t i = 0; i < m_dazzlers.size(); i++) {
+        Dazzler* dazzler = m_dazzlers[i].get();
+        m_dazzlerPorts[dazzler->getBasePort()] = dazzler;
+        m_dazzlerPorts[dazzler->getBasePort() + 1] = dazzler;
+
+        // Capture follows whichever card is first
+        DazzlerFrameHandler handler = (i == 0) ? m_dazzlerFrameHandler : nullptr;
+        dazzler->setFrameCallback(handler);
+    }
+    updateDazzlerWatch();
+}
+
+void EmulatorEngine::updateDazzlerWatch() {
+    std::fill(std::begin(m_dazzlerPageWatch), std::end(m_dazzlerPageWatch), 0);
+    for (size_t i = 0; i < m_dazzlers.size(); i++) {
+        const Dazzler* dazzler = m_dazzlers[i].get();
+        if (!dazzler->isEnabled()) continue;
+
+        // Picture memory starts on a 512-byte boundary and may wrap
+        int firstPage = dazzler->getFramebufferAddress() >> 8;
+        int pages = dazzler->getMemorySize() >> 8;
+        for (int p = 0; p < pages; p++) {
+            m_dazzlerPageWatch[(firstPage + p) & 0xFF] |= (uint8_t)(1u << i);
+        }
+    }
 }
 
 uint8_t EmulatorEngine::handleUnknownPortIn(uint8_t port) {
     // Handle Dazzler ports if enabled
-    if (m_dazzler) {
-        uint8_t basePort = m_dazzler->getBasePort();
-        if (port >= basePort && port < basePort + 2) {
-            return m_dazzler->portIn(port);
-        }
+    if (Dazzler* dazzler = m_dazzlerPorts[port]) {
+        return dazzler->portIn(port);
     }
     return 0xFF;  // Floating bus for unknown ports
 }
 
 void EmulatorEngine::handleUnknownPortOut(uint8_t port, uint8_t value) {
+    if (port == HOST_STREAM_PORT) {
+        handleHostStream();
+        return;
+    }
+
     // Handle Dazzler ports if enabled
-    if (m_dazzler) {
-        uint8_t basePort = m_dazzler->getBasePort();
-        if (port >= basePort && port < basePort + 2) {
-            m_dazzler->portOut(port, value);
+    if (Dazzler* dazzler = m_dazzlerPorts[port]) {
+        bool wasEnabled = dazzler->isEnabled();
+        uint16_t oldAddr = dazzler->getFramebufferAddress();
+        int oldSize = dazzler->getMemorySize();
+        dazzler->portOut(port, value);
+
+        // Only a moved or resized picture changes which pages are watched
+        if (dazzler->isEnabled() != wasEnabled || dazzler->getFramebufferAddress() != oldAddr ||
+            dazzler->getMemorySize() != oldSize) {
+            updateDazzlerWatch();
         }
     }
 }
\ No newline at end of file
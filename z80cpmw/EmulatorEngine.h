@@ -12,20 +12,30 @@
 #include <functional>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <memory>
 #include <cstdarg>
 #include "hbios_cpu.h"
+#include "DiskSlices.h"
 
 // Forward declarations
 class hbios_cpu;
 class banked_mem;
 class HBIOSDispatch;
 class Dazzler;
+struct DazzlerFrame;
 
 // Callback types
-using OutputCharCallback = std::function<void(uint8_t ch)>;
+// Guest console output, delivered in blocks
+using OutputCallback = std::function<void(const uint8_t* data, size_t count)>;
 using StatusCallback = std::function<void(const std::string& status)>;
+// Progress for long disk operations: (bytesDone, bytesTotal)
+using DiskProgressCallback = std::function<void(size_t done, size_t total)>;
+// Each completed Dazzler frame, on the emulator thread
+using DazzlerFrameHandler = std::function<void(const DazzlerFrame& frame)>;
+// A card has a new frame for its window, on the emulator thread
+using DazzlerUpdateHandler = std::function<void()>;
 
 class EmulatorEngine : public HBIOSCPUDelegate {
 public:
@@ -42,12 +52,18 @@ public:
     bool loadDisk(int unit, const std::string& path);
     bool loadDiskFromData(int unit, const uint8_t* data, size_t size);
     void closeDisk(int unit);
-    bool saveDisk(int unit, const std::string& path);
-    std::vector<uint8_t> getDiskData(int unit);
+    // Streams the image straight from the backing store (no copy); safe to
+    // call from a worker thread - execution is paused while it runs
+    bool saveDisk(int unit, const std::string& path, DiskProgressCallback progress = nullptr);
+    // Borrow an in-memory unit's image without copying it. Only valid while
+    // the emulator is paused and the unit stays loaded.
+    bool getDiskView(int unit, const uint8_t** data, size_t* size);
     bool isDiskLoaded(int unit) const;
     void setDiskPath(int unit, const std::string& path);
     const std::string& getDiskPath(int unit) const;
     void setDiskSliceCount(int unit, int slices);
+    // Per-slice residency and I/O counters (empty for in-memory units)
+    std::vector<DiskSliceStats> getDiskSliceStats(int unit) const;
 
     // Manifest disk protection (warn when writing to downloaded catalog disks)
     void setDiskIsManifest(int unit, bool isManifest);
@@ -57,6 +73,9 @@ public:
     // Flush all disk writes to storage
     void flushAllDisks();
 
+    // Journal disk writes (crash-safe); applies to disks loaded afterwards
+    void setJournalDiskWrites(bool enable);
+
     // Execution control
     void start();
     void stop();
@@ -65,7 +84,8 @@ public:
 
     // Input
     void sendChar(char ch);
-    void sendString(const std::string& str);
+    // Returns how many characters fit in the input queue (queue the rest later)
+    size_t sendString(const std::string& str);
 
     // NVRAM boot configuration
     // Set initial boot config (called on startup from saved config)
@@ -77,21 +97,21 @@ public:
     // Get current NVRAM setting (clears dirty flag)
     std::string getNvramSetting();
 
+    // Text display size reported to HBIOS (match the terminal)
+    void setTextSize(int rows, int cols);
+
     // Debug
     void setDebug(bool enable);
     uint16_t getProgramCounter() const;
     uint64_t getInstructionCount() const;
 
     // Callbacks
-    void setOutputCallback(OutputCharCallback cb) { m_outputCallback = cb; }
+    void setOutputCallback(OutputCallback cb) { m_outputCallback = cb; }
     void setStatusCallback(StatusCallback cb) { m_statusCallback = cb; }
-    OutputCharCallback getOutputCallback() const { return m_outputCallback; }
 
-    // Execute a batch of instructions (call from timer)
-    void runBatch();
-
-    // Flush buffered output to callback (call after runBatch)
-    void flushOutput();
+    // Drain queued console output to the callback (call from the UI timer);
+    // returns the number of bytes delivered
+    size_t flushOutput();
 
     // Get application directory (for read-only resources like ROMs)
     static std::string getAppDirectory();
@@ -115,49 +135,96 @@ public:
     //=========================================================================
     // Dazzler support
     //=========================================================================
-    Dazzler* getDazzler() { return m_dazzler.get(); }
-    void enableDazzler(uint8_t basePort = 0x0E, int scale = 2);
-    void disableDazzler();
-    bool isDazzlerEnabled() const { return m_dazzler != nullptr; }
+    // Up to MAX_DAZZLERS cards, each on its own pair of ports. Returns
+    // the new card, the one already on basePort, or nullptr if the ports
+    // overlap another card or the limit is reached.
+    Dazzler* enableDazzler(uint8_t basePort = 0x0E, int scale = 2);
+    void disableDazzler(uint8_t basePort);
+    void disableAllDazzlers();
+    Dazzler* getDazzler(uint8_t basePort);
+    bool isDazzlerEnabled() const { return !m_dazzlers.empty(); }
+
+    // Window notification for a card (nullptr clears it). Set under the
+    // engine lock so it never changes while endFrame() may be calling it.
+    void setDazzlerUpdateHandler(Dazzler* dazzler, DazzlerUpdateHandler handler);
+
+    // Frame capture hook for the first card; kept across disable/enable
+    void setDazzlerFrameHandler(DazzlerFrameHandler handler);
+
+    static constexpr int MAX_DAZZLERS = 8;
 
 private:
     void initCPU();
     void emulatorThread();
+    bool runBatch();  // Returns true if the guest is blocked waiting for input
     void handleHBIOS();
     void sendStatus(const std::string& status);
-    void processChar(uint8_t ch);
+
+    // Host file streams by handle, trapped on their own port because RST 8
+    // functions belong to the shared HBIOS dispatcher. B = function,
+    // C = handle (0 = the file opened through RST 8), DE = guest buffer or
+    // NUL-terminated filename, HL = byte count. Blocks return HL = bytes
+    // moved; A = 0 (open: the handle), or 0xFF at EOF / on failure.
+    void handleHostStream();
+    static constexpr uint8_t HOST_STREAM_PORT = 0xEE;
+    static constexpr uint8_t H_READ_BLOCK = 0xE6;   // Host file -> guest memory
+    static constexpr uint8_t H_WRITE_BLOCK = 0xE7;  // Guest memory -> host file
+    static constexpr uint8_t H_HOPEN_R = 0xE8;      // Open for reading, A = handle
+    static constexpr uint8_t H_HOPEN_W = 0xE9;      // Open for writing, A = handle
+    static constexpr uint8_t H_HCLOSE = 0xEA;       // Close handle C
+    static constexpr size_t HOST_FILENAME_MAX = 64;
+    std::vector<uint8_t> m_hostBlock;
+
+    // Rebuild the port table and page watch bits after cards come or go
+    void rebuildDazzlerMaps();
+    void updateDazzlerWatch();
 
     std::unique_ptr<banked_mem> m_memory;
     std::unique_ptr<hbios_cpu> m_cpu;
     std::unique_ptr<HBIOSDispatch> m_hbios;
-    std::unique_ptr<Dazzler> m_dazzler;
+    // Dazzler dispatch is a table lookup however many cards there are:
+    // the card answering each port, and per 256-byte page a bit for each
+    // card whose picture memory overlaps it
+    std::vector<std::unique_ptr<Dazzler>> m_dazzlers;
+    Dazzler* m_dazzlerPorts[256] = {};
+    uint8_t m_dazzlerPageWatch[256] = {};
+    DazzlerFrameHandler m_dazzlerFrameHandler;
 
     std::string m_romName;
     std::string m_diskPaths[4];
+    bool m_diskFileBacked[4] = {};  // Served from the file via emu_disk_* (not loaded in memory)
+    // Guards changes to the two above (made under m_mutex as well) against
+    // the UI's slice stats, which must not wait for m_mutex
+    mutable std::mutex m_diskPathMutex;
     std::string m_bootString;
+    bool m_journalDiskWrites = false;
+    std::chrono::steady_clock::time_point m_lastJournalCommit;
+    static constexpr auto JOURNAL_COMMIT_INTERVAL = std::chrono::milliseconds(250);
 
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_stopRequested{false};
     std::thread m_thread;
-    std::mutex m_mutex;
+    mutable std::mutex m_mutex;  // Held by the emulator thread while a batch runs
 
-    OutputCharCallback m_outputCallback;
+    OutputCallback m_outputCallback;
     StatusCallback m_statusCallback;
 
-    // VT100 escape sequence state
-    enum class EscapeState {
-        Normal,
-        Escape,
-        CSI,
-        CSIParam
-    };
-    EscapeState m_escapeState = EscapeState::Normal;
-    std::vector<int> m_escapeParams;
-    std::string m_escapeCurrentParam;
-
     // Instruction count for throttling
-    uint64_t m_instructionCount = 0;
+    std::atomic<uint64_t> m_instructionCount{0};
     static constexpr int BATCH_SIZE = 100000;
+    static constexpr auto BATCH_INTERVAL = std::chrono::milliseconds(10);
+    // Approximate emulated clock. The CPU core reports no per-instruction
+    // cycle count, so this is an instruction counter scaled by a nominal
+    // average, not a T-state clock: at the paced batch rate it tracks wall
+    // time, but display frames and the Dazzler status port follow the
+    // program's cycle timing only approximately.
+    static constexpr uint64_t NOMINAL_TICKS_PER_INSTRUCTION = 5;
+    static constexpr uint64_t NOMINAL_CLOCK_HZ = BATCH_SIZE * NOMINAL_TICKS_PER_INSTRUCTION * 100;
+    static constexpr uint64_t FRAME_TICKS = NOMINAL_CLOCK_HZ / 60;  // 60 Hz display frame
+    uint64_t m_clockTicks = 0;      // Emulator thread (and reset) only
+    uint64_t m_nextFrame = 0;       // Tick of the next frame boundary
+    // Output ring space a batch may need; more than one batch can print
+    static constexpr size_t OUTPUT_HEADROOM = 128 * 1024;
 
     // RAM bank initialization now uses HBIOSDispatch's shared bitmap
     // via m_hbios->getInitializedBanksBitmap() - see "Unified RAM Bank Initialization"
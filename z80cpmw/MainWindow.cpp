@@ -9,6 +9,9 @@
 #include "DiskCatalog.h"
 #include "DazzlerWindow.h"
 #include "Dazzler.h"
+#include "DiskContainer.h"
+#include "BlockStore.h"
+#include "emu_io.h"
 #include "SettingsDialogWx.h"
 #include "HelpWindow.h"
 #include "resource.h"
@@ -21,6 +24,18 @@ static const wchar_t* WINDOW_CLASS = L"Z80CPM_MainWindow";
 static const wchar_t* WINDOW_TITLE = L"z80cpmw - Z80 CP/M Emulator";
 static bool g_mainClassRegistered = false;
 
+// Commands that need the engine lock, which a disk save holds until it
+// finishes, or the disk worker; they are greyed out (and their accelerators
+// ignored) while a save or conversion runs
+static const int ENGINE_COMMANDS[] = {
+    ID_FILE_LOADDISK0, ID_FILE_LOADDISK1, ID_FILE_SAVEDISK0, ID_FILE_SAVEDISK1,
+    ID_FILE_SAVEDISKS, ID_FILE_COMPRESSDISK, ID_FILE_EXPANDDISK, ID_FILE_DEDUPDISK,
+    ID_FILE_CLONEDISK, ID_FILE_LOADPROFILE, ID_FILE_SAVEPROFILE,
+    ID_ROM_EMU_AVW, ID_ROM_EMU_ROMWBW, ID_ROM_SBC_SIMH,
+    ID_EMU_START, ID_EMU_STOP, ID_EMU_RESET, ID_EMU_SETTINGS, ID_EMU_REPLAY,
+    ID_VIEW_DAZZLER, ID_VIEW_DAZZLER_CAPTURE,
+};
+
 MainWindow::MainWindow()
     : m_terminal(std::make_unique<TerminalView>())
     , m_emulator(std::make_unique<EmulatorEngine>())
@@ -59,8 +74,8 @@ bool MainWindow::create() {
     // Calculate window size based on terminal dimensions
     int charWidth = 10;  // Approximate for 20pt font
     int charHeight = 20;
-    int termWidth = TerminalView::COLS * charWidth + 20;
-    int termHeight = TerminalView::ROWS * charHeight + 50;
+    int termWidth = TerminalView::DEFAULT_COLS * charWidth + 20;
+    int termHeight = TerminalView::DEFAULT_ROWS * charHeight + 50;
 
     // Adjust for window frame, menu, and status bar
     RECT rect = { 0, 0, termWidth, termHeight };
@@ -145,6 +160,36 @@ LRESULT MainWindow::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         }
         return 0;
 
+    case WM_APP: {  // Disk task progress (wParam = percent)
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%s... %d%%", m_diskTaskLabel.c_str(), (int)wParam);
+        m_statusText = buf;
+        updateStatusBar();
+        return 0;
+    }
+
+    case WM_APP + 1: {  // Disk task finished (lParam = std::string* result, or null on failure)
+        std::unique_ptr<std::string> result((std::string*)lParam);
+        if (m_diskTaskThread.joinable()) {
+            m_diskTaskThread.join();
+        }
+        m_diskTaskInProgress = false;
+        updateMenuState();
+        if (result) {
+            m_statusText = *result;
+            updateStatusBar();
+        } else {
+            m_statusText = m_diskTaskFailure;
+            updateStatusBar();
+            MessageBoxA(m_hwnd, m_diskTaskFailure.c_str(), "Error", MB_OK | MB_ICONERROR);
+        }
+        if (m_closePending) {
+            // Closing was put off until the task let go of the engine
+            PostMessage(m_hwnd, WM_CLOSE, 0, 0);
+        }
+        return 0;
+    }
+
     case WM_SETFOCUS:
         if (m_terminal && m_terminal->getHwnd()) {
             SetFocus(m_terminal->getHwnd());
@@ -152,6 +197,14 @@ LRESULT MainWindow::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         return 0;
 
     case WM_CLOSE:
+        // Stopping would wait on the emulator thread, itself waiting for
+        // a save to release the engine; close once the task is done
+        if (m_diskTaskInProgress) {
+            m_closePending = true;
+            m_statusText = "Closing once the disk operation finishes...";
+            updateStatusBar();
+            return 0;
+        }
         if (m_emulator && m_emulator->isRunning()) {
             m_emulator->stop();
         }
@@ -208,12 +261,13 @@ void MainWindow::onCreate() {
     m_terminal->setKeyInputCallback([this](char ch) {
         if (m_emulator && m_emulator->isRunning()) {
             m_emulator->sendChar(ch);
+            m_recorder.recordInput(&ch, 1);
         }
     });
 
     // Set up emulator callbacks
-    m_emulator->setOutputCallback([this](uint8_t ch) {
-        onOutputChar(ch);
+    m_emulator->setOutputCallback([this](const uint8_t* data, size_t count) {
+        onOutput(data, count);
     });
 
     m_emulator->setStatusCallback([this](const std::string& status) {
@@ -245,18 +299,34 @@ void MainWindow::onDestroy() {
         m_emulatorTimer = 0;
     }
 
-    // Clean up Dazzler window
-    if (m_dazzlerWindow) {
-        m_dazzlerWindow->destroy();
-        m_dazzlerWindow.reset();
+    m_recorder.stop();
+    stopDazzlerCapture();
+
+    // Let an in-flight save or conversion finish before the engine goes away
+    if (m_diskTaskThread.joinable()) {
+        m_diskTaskThread.join();
+    }
+
+    // Clean up Dazzler windows once the emulator thread can no longer
+    // notify them (WM_CLOSE normally stopped it already)
+    if (m_emulator) {
+        m_emulator->stop();
+    }
+    for (auto& window : m_dazzlerWindows) {
+        window->destroy();
     }
+    m_dazzlerWindows.clear();
 
     PostQuitMessage(0);
 }
 
 void MainWindow::onSize(int width, int height) {
-    // Resize status bar
+    // Resize status bar; the right-hand part shows disk slice activity
     SendMessage(m_statusBar, WM_SIZE, 0, 0);
+    if (m_statusBar) {
+        int parts[2] = { std::max(0, width - DISK_STATUS_WIDTH), -1 };
+        SendMessage(m_statusBar, SB_SETPARTS, 2, (LPARAM)parts);
+    }
 
     // Get status bar height
     RECT statusRect = {};
@@ -282,6 +352,13 @@ void MainWindow::onSize(int width, int height) {
 }
 
 void MainWindow::onCommand(int id) {
+    // Accelerators reach here even while the menu items are greyed
+    if (m_diskTaskInProgress &&
+        std::find(std::begin(ENGINE_COMMANDS), std::end(ENGINE_COMMANDS), id) != std::end(ENGINE_COMMANDS)) {
+        MessageBeep(MB_OK);
+        return;
+    }
+
     switch (id) {
     case ID_FILE_LOADDISK0:
         onFileLoadDisk(0);
@@ -298,6 +375,18 @@ void MainWindow::onCommand(int id) {
     case ID_FILE_SAVEDISKS:
         onFileSaveAllDisks();
         break;
+    case ID_FILE_COMPRESSDISK:
+        onFileCompressDisk();
+        break;
+    case ID_FILE_EXPANDDISK:
+        onFileExpandDisk();
+        break;
+    case ID_FILE_DEDUPDISK:
+        onFileDedupDisk();
+        break;
+    case ID_FILE_CLONEDISK:
+        onFileCloneDisk();
+        break;
     case ID_FILE_LOADPROFILE:
         onLoadProfile();
         break;
@@ -323,9 +412,24 @@ void MainWindow::onCommand(int id) {
     case ID_EMU_RESET:
         onEmulatorReset();
         break;
+    case ID_EMU_PASTE:
+        onEmulatorPaste();
+        break;
     case ID_EMU_SETTINGS:
         onEmulatorSettings();
         break;
+    case ID_EMU_RECORD:
+        onEmulatorRecord();
+        break;
+    case ID_EMU_REPLAY:
+        onEmulatorReplay();
+        break;
+    case ID_EMU_REPLAY_1X:
+    case ID_EMU_REPLAY_4X:
+    case ID_EMU_REPLAY_16X:
+    case ID_EMU_REPLAY_MAX:
+        setReplaySpeed(id);
+        break;
 
     case ID_VIEW_FONT14:
         onViewFontSize(14);
@@ -346,9 +450,34 @@ void MainWindow::onCommand(int id) {
         onViewFontSize(28);
         break;
 
+    case ID_VIEW_TERM_80X24:
+        onViewTerminalSize(24, 80);
+        break;
+    case ID_VIEW_TERM_80X25:
+        onViewTerminalSize(25, 80);
+        break;
+    case ID_VIEW_TERM_80X43:
+        onViewTerminalSize(43, 80);
+        break;
+    case ID_VIEW_TERM_80X50:
+        onViewTerminalSize(50, 80);
+        break;
+    case ID_VIEW_TERM_132X25:
+        onViewTerminalSize(25, 132);
+        break;
+    case ID_VIEW_TERM_132X43:
+        onViewTerminalSize(43, 132);
+        break;
+    case ID_VIEW_TERM_132X60:
+        onViewTerminalSize(60, 132);
+        break;
+
     case ID_VIEW_DAZZLER:
         onViewDazzler();
         break;
+    case ID_VIEW_DAZZLER_CAPTURE:
+        onViewDazzlerCapture();
+        break;
 
     case ID_HELP_TOPICS:
         onHelpTopics();
@@ -361,20 +490,33 @@ void MainWindow::onCommand(int id) {
 }
 
 void MainWindow::onTimer() {
-    if (m_emulator && m_emulator->isRunning()) {
-        m_emulator->runBatch();
+    // The emulator runs on its own thread; the UI only drains its output
+    if (m_emulator) {
         m_emulator->flushOutput();
+    }
+    feedPaste();
+    if (m_player) {
+        pumpReplay();
+    }
 
-        // Force terminal to repaint after batch processing
-        if (m_terminal) {
-            m_terminal->repaint();
-        }
+    // A save worker holds the engine while it streams the image out (a
+    // conversion doesn't, but the status bar shows its progress meanwhile)
+    if (m_diskTaskInProgress) {
+        if (m_terminal) m_terminal->tick();
+        return;
+    }
 
-        // Update Dazzler window if enabled
-        if (m_dazzlerWindow && m_dazzlerEnabled) {
-            m_dazzlerWindow->repaint();
-        }
+    // Paint whatever rows changed (nothing at all on an idle screen; floods
+    // only at the refresh rate); this also covers output written while the
+    // emulator is stopped
+    if (m_terminal) {
+        m_terminal->tick();
+    }
+
+    // The Dazzler window is invalidated by the emulator once per emulated
+    // frame in which the picture changed; nothing to poll here
 
+    if (m_emulator && m_emulator->isRunning()) {
         // Update status bar with instruction count every ~500ms
         static int timerCount = 0;
         if (++timerCount >= 50) {  // 50 * 10ms = 500ms
@@ -385,6 +527,7 @@ void MainWindow::onTimer() {
                     m_emulator->getInstructionCount());
             m_statusText = buf;
             updateStatusBar();
+            updateDiskStatus();
 
             // Check for NVRAM changes (user configured via ROM's SYSCONF utility)
             if (m_emulator->hasNvramChange()) {
@@ -419,7 +562,7 @@ void MainWindow::onFileLoadDisk(int unit) {
     OPENFILENAMEW ofn = {};
     ofn.lStructSize = sizeof(ofn);
     ofn.hwndOwner = m_hwnd;
-    ofn.lpstrFilter = L"Disk Images (*.img)\0*.img\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFilter = L"Disk Images (*.img;*.imz;*.imgref)\0*.img;*.imz;*.imgref\0All Files (*.*)\0*.*\0";
     ofn.lpstrFile = filename;
     ofn.nMaxFile = MAX_PATH;
     ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
@@ -462,29 +605,240 @@ void MainWindow::onFileSaveDisk(int unit) {
         char path[MAX_PATH];
         WideCharToMultiByte(CP_UTF8, 0, filename, -1, path, MAX_PATH, nullptr, nullptr);
 
-        if (m_emulator->saveDisk(unit, path)) {
-            m_statusText = "Saved disk " + std::to_string(unit);
-            updateStatusBar();
-        } else {
-            MessageBoxW(m_hwnd, L"Failed to save disk image", L"Error", MB_OK | MB_ICONERROR);
-        }
+        startDiskSave({ { unit, path } });
     }
 }
 
 void MainWindow::onFileSaveAllDisks() {
-    std::string appDir = EmulatorEngine::getAppDirectory();
-
-    for (int unit = 0; unit < 2; unit++) {
+    std::vector<std::pair<int, std::string>> jobs;
+    for (int unit = 0; unit < 4; unit++) {
         if (m_emulator->isDiskLoaded(unit)) {
             std::string path = m_emulator->getDiskPath(unit);
             if (!path.empty()) {
-                m_emulator->saveDisk(unit, path);
+                jobs.emplace_back(unit, path);
             }
         }
     }
 
-    m_statusText = "All disks saved";
+    if (jobs.empty()) {
+        m_statusText = "No disks to save";
+        updateStatusBar();
+        return;
+    }
+    startDiskSave(std::move(jobs));
+}
+
+void MainWindow::startDiskSave(std::vector<std::pair<int, std::string>> jobs) {
+    EmulatorEngine* emulator = m_emulator.get();
+    startDiskTask("Saving disk", "Failed to save disk image",
+        [emulator, jobs = std::move(jobs)](const auto& progress) -> std::string {
+            for (size_t i = 0; i < jobs.size(); i++) {
+                // Overall progress across all units being saved
+                bool ok = emulator->saveDisk(jobs[i].first, jobs[i].second,
+                    [&](size_t done, size_t total) {
+                        progress(i * 1000 + (total ? done * 1000 / total : 1000), jobs.size() * 1000);
+                    });
+                if (!ok) return "";
+            }
+            return jobs.size() == 1 ? "Saved disk " + std::to_string(jobs[0].first) : "All disks saved";
+        });
+}
+
+void MainWindow::startDiskTask(const std::string& label, const std::string& failure, DiskTask work) {
+    if (m_diskTaskInProgress) {
+        MessageBoxW(m_hwnd, L"A disk save or conversion is already in progress", L"Disk Images",
+                    MB_OK | MB_ICONINFORMATION);
+        return;
+    }
+
+    // A finished worker is joined when its completion message arrives
+    if (m_diskTaskThread.joinable()) {
+        m_diskTaskThread.join();
+    }
+
+    m_diskTaskInProgress = true;
+    m_diskTaskLabel = label;
+    m_diskTaskFailure = failure;
+    m_statusText = label + "...";
     updateStatusBar();
+    updateMenuState();
+
+    HWND hwnd = m_hwnd;
+    m_diskTaskThread = std::thread([hwnd, work = std::move(work)]() {
+        int lastPercent = -1;
+        std::string status = work([&](size_t done, size_t total) {
+            int percent = (int)(total ? (uint64_t)done * 100 / total : 100);
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                PostMessage(hwnd, WM_APP, (WPARAM)percent, 0);
+            }
+        });
+        PostMessage(hwnd, WM_APP + 1, 0, (LPARAM)(status.empty() ? nullptr : new std::string(status)));
+    });
+}
+
+void MainWindow::onFileCompressDisk() {
+    wchar_t source[MAX_PATH] = {};
+    wchar_t target[MAX_PATH] = {};
+
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Disk Images (*.img)\0*.img\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFile = source;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
+    ofn.lpstrTitle = L"Compress Disk Image";
+    if (!GetOpenFileNameW(&ofn)) return;
+
+    // Default the output name to the source with an .imz extension
+    wcscpy_s(target, source);
+    wchar_t* dot = wcsrchr(target, L'.');
+    if (dot) *dot = L'\0';
+    wcscat_s(target, L".imz");
+
+    ofn.lpstrFilter = L"Compressed Disk Images (*.imz)\0*.imz\0";
+    ofn.lpstrFile = target;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Save Compressed Disk Image";
+    ofn.lpstrDefExt = L"imz";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char sourcePath[MAX_PATH];
+    char targetPath[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, source, -1, sourcePath, MAX_PATH, nullptr, nullptr);
+    WideCharToMultiByte(CP_UTF8, 0, target, -1, targetPath, MAX_PATH, nullptr, nullptr);
+
+    startDiskTask("Compressing disk image", "Failed to compress disk image",
+        [source = std::string(sourcePath), target = std::string(targetPath)](const auto& progress) -> std::string {
+            if (!DiskContainer::importRaw(source, target, progress)) return "";
+            char buf[128];
+            snprintf(buf, sizeof(buf), "Compressed disk image: %zu KB -> %zu KB",
+                     emu_file_size(source) / 1024, emu_file_size(target) / 1024);
+            return buf;
+        });
+}
+
+void MainWindow::onFileExpandDisk() {
+    wchar_t source[MAX_PATH] = {};
+    wchar_t target[MAX_PATH] = {};
+
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Compressed/Deduplicated Images (*.imz;*.imgref)\0*.imz;*.imgref\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFile = source;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
+    ofn.lpstrTitle = L"Expand Disk Image";
+    if (!GetOpenFileNameW(&ofn)) return;
+
+    wcscpy_s(target, source);
+    wchar_t* dot = wcsrchr(target, L'.');
+    if (dot) *dot = L'\0';
+    wcscat_s(target, L".img");
+
+    ofn.lpstrFilter = L"Disk Images (*.img)\0*.img\0";
+    ofn.lpstrFile = target;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Save Expanded Disk Image";
+    ofn.lpstrDefExt = L"img";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char sourcePath[MAX_PATH];
+    char targetPath[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, source, -1, sourcePath, MAX_PATH, nullptr, nullptr);
+    WideCharToMultiByte(CP_UTF8, 0, target, -1, targetPath, MAX_PATH, nullptr, nullptr);
+
+    startDiskTask("Expanding disk image", "Failed to expand disk image",
+        [source = std::string(sourcePath), target = std::string(targetPath)](const auto& progress) -> std::string {
+            return exportRawImage(source, target, progress) ? "Expanded disk image" : "";
+        });
+}
+
+void MainWindow::onFileDedupDisk() {
+    wchar_t source[MAX_PATH] = {};
+    wchar_t target[MAX_PATH] = {};
+
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Disk Images (*.img)\0*.img\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFile = source;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
+    ofn.lpstrTitle = L"Deduplicate Disk Image";
+    if (!GetOpenFileNameW(&ofn)) return;
+
+    wcscpy_s(target, source);
+    wchar_t* dot = wcsrchr(target, L'.');
+    if (dot) *dot = L'\0';
+    wcscat_s(target, L".imgref");
+
+    ofn.lpstrFilter = L"Deduplicated Disk Images (*.imgref)\0*.imgref\0";
+    ofn.lpstrFile = target;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Save Deduplicated Disk Image";
+    ofn.lpstrDefExt = L"imgref";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char sourcePath[MAX_PATH];
+    char targetPath[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, source, -1, sourcePath, MAX_PATH, nullptr, nullptr);
+    WideCharToMultiByte(CP_UTF8, 0, target, -1, targetPath, MAX_PATH, nullptr, nullptr);
+
+    startDiskTask("Deduplicating disk image", "Failed to deduplicate disk image",
+        [source = std::string(sourcePath), target = std::string(targetPath)](const auto& progress) -> std::string {
+            // Replacing an existing image drops its references first
+            if (BlockStore::isImage(target)) {
+                BlockStore::deleteImage(target);
+            }
+            if (!BlockStore::importRaw(source, target, progress)) return "";
+            char buf[128];
+            snprintf(buf, sizeof(buf), "Deduplicated disk image: %zu unique blocks in store",
+                     BlockStore::instance().blockCount());
+            return buf;
+        });
+}
+
+void MainWindow::onFileCloneDisk() {
+    wchar_t source[MAX_PATH] = {};
+    wchar_t target[MAX_PATH] = {};
+
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Deduplicated Disk Images (*.imgref)\0*.imgref\0";
+    ofn.lpstrFile = source;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
+    ofn.lpstrTitle = L"Clone Disk Image";
+    if (!GetOpenFileNameW(&ofn)) return;
+
+    ofn.lpstrFile = target;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Save Cloned Disk Image";
+    ofn.lpstrDefExt = L"imgref";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char sourcePath[MAX_PATH];
+    char targetPath[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, source, -1, sourcePath, MAX_PATH, nullptr, nullptr);
+    WideCharToMultiByte(CP_UTF8, 0, target, -1, targetPath, MAX_PATH, nullptr, nullptr);
+
+    // Any unit using the source must have its pending writes in the image
+    m_emulator->flushAllDisks();
+
+    if (BlockStore::isImage(targetPath)) {
+        BlockStore::deleteImage(targetPath);
+    }
+
+    if (BlockStore::cloneImage(sourcePath, targetPath)) {
+        m_statusText = "Cloned disk image";
+        updateStatusBar();
+    } else {
+        MessageBoxW(m_hwnd, L"Failed to clone disk image", L"Error", MB_OK | MB_ICONERROR);
+    }
 }
 
 void MainWindow::onSelectROM(int romId) {
@@ -522,6 +876,11 @@ void MainWindow::onSelectROM(int romId) {
 }
 
 void MainWindow::onEmulatorStart() {
+    // The terminal belongs to the guest again
+    if (m_player) {
+        endReplay();
+    }
+
     // If downloads are in progress, wait for them
     if (m_downloadingDisks) {
         // Output message to terminal
@@ -725,10 +1084,162 @@ void MainWindow::onEmulatorReset() {
     if (m_terminal) {
         m_terminal->clear();
     }
+    m_pasteBuffer.clear();
+    m_pasteOffset = 0;
     m_emulator->reset();
     updateMenuState();
 }
 
+void MainWindow::onEmulatorPaste() {
+    if (!m_emulator || !m_emulator->isRunning()) return;
+    if (!OpenClipboard(m_hwnd)) return;
+
+    HANDLE data = GetClipboardData(CF_TEXT);
+    const char* text = data ? (const char*)GlobalLock(data) : nullptr;
+    if (text) {
+        // CP/M wants CR line endings; drop the LF of each CRLF pair
+        for (const char* p = text; *p; p++) {
+            if (*p == '\n' && p > text && p[-1] == '\r') continue;
+            m_pasteBuffer += (*p == '\n') ? '\r' : *p;
+        }
+        GlobalUnlock(data);
+    }
+    CloseClipboard();
+    feedPaste();
+}
+
+void MainWindow::feedPaste() {
+    if (m_pasteOffset >= m_pasteBuffer.size()) return;
+    if (!m_emulator || !m_emulator->isRunning()) return;
+
+    // Whatever doesn't fit in the input queue now goes in on later ticks
+    size_t queued = m_emulator->sendString(m_pasteBuffer.substr(m_pasteOffset, PASTE_CHUNK));
+    m_recorder.recordInput(m_pasteBuffer.data() + m_pasteOffset, queued);
+    m_pasteOffset += queued;
+    if (m_pasteOffset >= m_pasteBuffer.size()) {
+        m_pasteBuffer.clear();
+        m_pasteOffset = 0;
+    }
+}
+
+void MainWindow::onEmulatorRecord() {
+    if (m_recorder.isRecording()) {
+        m_recorder.stop();
+        m_statusText = "Recording saved";
+        updateStatusBar();
+        updateMenuState();
+        return;
+    }
+
+    wchar_t filename[MAX_PATH] = L"session.cast";
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Session Recordings (*.cast)\0*.cast\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFile = filename;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Record Session";
+    ofn.lpstrDefExt = L"cast";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char path[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, filename, -1, path, MAX_PATH, nullptr, nullptr);
+
+    std::string error;
+    bool recordInput = config::ConfigManager::instance().get().recordInput;
+    if (!m_recorder.start(path, m_terminal->getCols(), m_terminal->getRows(), recordInput, error)) {
+        MessageBoxA(m_hwnd, error.c_str(), "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    m_statusText = "Recording session";
+    updateStatusBar();
+    updateMenuState();
+}
+
+void MainWindow::onEmulatorReplay() {
+    if (m_emulator->isRunning()) return;
+
+    wchar_t filename[MAX_PATH] = {};
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Session Recordings (*.cast)\0*.cast\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFile = filename;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY;
+    ofn.lpstrTitle = L"Replay Recording";
+    if (!GetOpenFileNameW(&ofn)) return;
+
+    char path[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, filename, -1, path, MAX_PATH, nullptr, nullptr);
+
+    auto player = std::make_unique<SessionPlayer>();
+    std::string error;
+    if (!player->load(path, error)) {
+        MessageBoxA(m_hwnd, error.c_str(), "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    // Replay at the recorded geometry; endReplay() restores the configured one
+    if (player->rows() != m_terminal->getRows() || player->cols() != m_terminal->getCols()) {
+        m_terminal->setGeometry(player->rows(), player->cols());
+        fitWindowToTerminal();
+    }
+    m_terminal->clear();
+
+    m_player = std::move(player);
+    m_player->start(m_replaySpeed);
+    m_replayStart = std::chrono::steady_clock::now();
+    m_statusText = "Replaying recording";
+    updateStatusBar();
+    updateMenuState();
+}
+
+void MainWindow::setReplaySpeed(int menuId) {
+    switch (menuId) {
+    case ID_EMU_REPLAY_1X:  m_replaySpeed = 1.0; break;
+    case ID_EMU_REPLAY_4X:  m_replaySpeed = 4.0; break;
+    case ID_EMU_REPLAY_16X: m_replaySpeed = 16.0; break;
+    case ID_EMU_REPLAY_MAX: m_replaySpeed = 0.0; break;
+    }
+    CheckMenuRadioItem(m_menu, ID_EMU_REPLAY_1X, ID_EMU_REPLAY_MAX, menuId, MF_BYCOMMAND);
+
+    // A replay in progress carries on from where it is
+    if (m_player) {
+        m_player->setSpeed(m_replaySpeed);
+    }
+}
+
+void MainWindow::pumpReplay() {
+    // Output goes straight to the terminal, exactly as a flush would deliver it
+    m_player->pump([this](const uint8_t* data, size_t count) {
+        m_terminal->output(data, count);
+    }, REPLAY_CHUNK);
+
+    if (m_player->finished()) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_replayStart).count();
+        size_t bytes = m_player->outputBytes();
+        char buf[128];
+        snprintf(buf, sizeof(buf), "Replay finished: %zu KB in %.2f s (%.1f MB/s)",
+                 bytes / 1024, seconds, seconds > 0 ? bytes / seconds / (1024 * 1024) : 0.0);
+        endReplay();
+        m_statusText = buf;
+        updateStatusBar();
+    }
+}
+
+void MainWindow::endReplay() {
+    m_player.reset();
+
+    const auto& cfg = config::ConfigManager::instance().get();
+    if (cfg.terminalRows != m_terminal->getRows() || cfg.terminalCols != m_terminal->getCols()) {
+        m_terminal->setGeometry(cfg.terminalRows, cfg.terminalCols);
+        fitWindowToTerminal();
+    }
+    updateMenuState();
+}
+
 void MainWindow::onEmulatorSettings() {
     // Stop emulator while settings dialog is open
     bool wasRunning = m_emulator && m_emulator->isRunning();
@@ -743,6 +1254,7 @@ void MainWindow::onEmulatorSettings() {
     // Pass currently loaded disk filenames to settings dialog from config
     const auto& cfg = config::ConfigManager::instance().get();
     settings.warnManifestWrites = cfg.warnManifestWrites;
+    settings.journalDiskWrites = cfg.journalDiskWrites;
     for (int i = 0; i < 4; i++) {
         if (cfg.disks[i].has_value() && !cfg.disks[i]->path.empty()) {
             // Extract filename from full path
@@ -816,6 +1328,10 @@ void MainWindow::onEmulatorSettings() {
             m_emulator->setDiskWarningSuppressed(i, !settings.warnManifestWrites);
         }
 
+        // Journal mode takes effect for disks loaded from now on
+        cfgMut.journalDiskWrites = settings.journalDiskWrites;
+        m_emulator->setJournalDiskWrites(settings.journalDiskWrites);
+
         // Save settings to disk
         saveSettings();
 
@@ -839,60 +1355,185 @@ void MainWindow::onViewFontSize(int size) {
     }
 }
 
+void MainWindow::onViewTerminalSize(int rows, int cols) {
+    if (!m_terminal) return;
+
+    m_terminal->setGeometry(rows, cols);
+    m_emulator->setTextSize(m_terminal->getRows(), m_terminal->getCols());
+
+    auto& cfg = config::ConfigManager::instance().get();
+    cfg.terminalRows = m_terminal->getRows();
+    cfg.terminalCols = m_terminal->getCols();
+    checkTerminalSizeMenuItem(cfg.terminalRows, cfg.terminalCols);
+    fitWindowToTerminal();
+    saveSettings();
+}
+
+void MainWindow::fitWindowToTerminal() {
+    if (!m_terminal || IsZoomed(m_hwnd)) return;
+
+    RECT statusRect = {};
+    if (m_statusBar) {
+        GetWindowRect(m_statusBar, &statusRect);
+    }
+    int statusHeight = statusRect.bottom - statusRect.top;
+
+    RECT rect = { 0, 0,
+                  m_terminal->getCols() * m_terminal->getCharWidth(),
+                  m_terminal->getRows() * m_terminal->getCharHeight() + statusHeight };
+    AdjustWindowRect(&rect, (DWORD)GetWindowLongPtr(m_hwnd, GWL_STYLE), TRUE);
+    SetWindowPos(m_hwnd, nullptr, 0, 0, rect.right - rect.left, rect.bottom - rect.top,
+                 SWP_NOMOVE | SWP_NOZORDER);
+}
+
 void MainWindow::onViewDazzler() {
-    m_dazzlerEnabled = !m_dazzlerEnabled;
+    if (m_dazzlerEnabled) {
+        closeDazzlers();
+        m_statusText = "Dazzler disabled";
+    } else {
+        // Cards flagged in the config, or every configured card if none is
+        // (turning the Dazzler off clears the flags)
+        const auto& cfg = config::ConfigManager::instance().get();
+        bool anyFlagged = std::any_of(cfg.dazzlers.begin(), cfg.dazzlers.end(),
+                                      [](const config::DazzlerConfig& d) { return d.enabled; });
+        openDazzlers(anyFlagged);
+
+        m_statusText = "Dazzler enabled (port";
+        for (const auto& window : m_dazzlerWindows) {
+            char port[8];
+            snprintf(port, sizeof(port), " %02Xh", window->getDazzler()->getBasePort());
+            m_statusText += port;
+        }
+        m_statusText += ")";
+    }
 
     // Update menu checkmark
     CheckMenuItem(m_menu, ID_VIEW_DAZZLER, m_dazzlerEnabled ? MF_CHECKED : MF_UNCHECKED);
 
-    // Get Dazzler config (use first one or create default)
+    // Save Dazzler state to config
+    saveSettings();
+
+    updateStatusBar();
+    updateMenuState();
+}
+
+void MainWindow::openDazzlers(bool flaggedOnly) {
     auto& cfg = config::ConfigManager::instance().get();
-    uint8_t port = 0x0E;
-    int scale = 4;
-    if (!cfg.dazzlers.empty()) {
-        port = cfg.dazzlers[0].port;
-        scale = cfg.dazzlers[0].scale;
+    if (cfg.dazzlers.empty()) {
+        cfg.dazzlers.push_back(config::DazzlerConfig{});
     }
 
-    if (m_dazzlerEnabled) {
-        // Enable Dazzler in emulator
-        m_emulator->enableDazzler(port, scale);
+    // Windows cascade from the right edge of the main window
+    RECT mainRect;
+    GetWindowRect(m_hwnd, &mainRect);
 
-        // Create Dazzler window
-        if (!m_dazzlerWindow) {
-            m_dazzlerWindow = std::make_unique<DazzlerWindow>();
+    for (const auto& daz : cfg.dazzlers) {
+        if (flaggedOnly && !daz.enabled) continue;
 
-            // Position next to main window
-            RECT mainRect;
-            GetWindowRect(m_hwnd, &mainRect);
-            m_dazzlerWindow->create(m_hwnd, mainRect.right + 10, mainRect.top, scale);
+        // Overlapping ports, a repeated entry or too many cards: skipped
+        Dazzler* dazzler = m_emulator->enableDazzler(daz.port, daz.scale);
+        if (!dazzler || std::any_of(m_dazzlerWindows.begin(), m_dazzlerWindows.end(),
+                                    [dazzler](const auto& w) { return w->getDazzler() == dazzler; })) {
+            continue;
         }
 
-        // Connect to emulator's Dazzler
-        if (m_dazzlerWindow && m_emulator->getDazzler()) {
-            m_dazzlerWindow->setDazzler(m_emulator->getDazzler());
-            m_dazzlerWindow->show(true);
+        int offset = 30 * (int)m_dazzlerWindows.size();
+        auto window = std::make_unique<DazzlerWindow>();
+        if (!window->create(m_hwnd, mainRect.right + 10 + offset, mainRect.top + offset, daz.scale)) {
+            m_emulator->disableDazzler(daz.port);
+            continue;
         }
-
-        m_statusText = "Dazzler enabled (port 0x" +
-            std::to_string(port) + ")";
-    } else {
-        // Hide and disconnect Dazzler window
-        if (m_dazzlerWindow) {
-            m_dazzlerWindow->show(false);
-            m_dazzlerWindow->setDazzler(nullptr);
+        if (cfg.dazzlers.size() > 1) {
+            wchar_t title[64];
+            swprintf(title, 64, L"Cromemco Dazzler (port %02Xh)", daz.port);
+            SetWindowTextW(window->getHwnd(), title);
         }
+        window->setDazzler(dazzler);
+        DazzlerWindow* target = window.get();
+        m_emulator->setDazzlerUpdateHandler(dazzler, [target] { target->invalidate(); });
+        window->show(true);
+        m_dazzlerWindows.push_back(std::move(window));
+    }
+
+    m_dazzlerEnabled = !m_dazzlerWindows.empty();
+}
 
-        // Disable Dazzler in emulator
-        m_emulator->disableDazzler();
+void MainWindow::closeDazzlers() {
+    stopDazzlerCapture();
 
-        m_statusText = "Dazzler disabled";
+    // Cards (and their update handlers) go first, under the engine lock,
+    // so the emulator thread can't notify a window being destroyed
+    m_emulator->disableAllDazzlers();
+
+    for (auto& window : m_dazzlerWindows) {
+        window->setDazzler(nullptr);
+        window->destroy();
     }
+    m_dazzlerWindows.clear();
 
-    // Save Dazzler state to config
-    saveSettings();
+    m_dazzlerEnabled = false;
+}
+
+void MainWindow::onViewDazzlerCapture() {
+    if (m_dazzlerCapture.isCapturing()) {
+        stopDazzlerCapture();
+        updateStatusBar();
+        updateMenuState();
+        return;
+    }
+    if (!m_dazzlerEnabled) return;
+
+    wchar_t filename[MAX_PATH] = L"dazzler.gif";
+    OPENFILENAMEW ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = m_hwnd;
+    ofn.lpstrFilter = L"Animated GIF (*.gif)\0*.gif\0PNG Sequence (*.png)\0*.png\0";
+    ofn.lpstrFile = filename;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.Flags = OFN_OVERWRITEPROMPT;
+    ofn.lpstrTitle = L"Capture Dazzler";
+    ofn.lpstrDefExt = L"gif";
+    if (!GetSaveFileNameW(&ofn)) return;
+
+    char path[MAX_PATH];
+    WideCharToMultiByte(CP_UTF8, 0, filename, -1, path, MAX_PATH, nullptr, nullptr);
 
+    // The chosen file type decides the format
+    DazzlerCapture::Format format = ofn.nFilterIndex == 2 ?
+        DazzlerCapture::Format::PngSequence : DazzlerCapture::Format::Gif;
+
+    std::string error;
+    bool dedupe = config::ConfigManager::instance().get().dazzlerCaptureDedupe;
+    if (!m_dazzlerCapture.start(path, format, dedupe, error)) {
+        MessageBoxA(m_hwnd, error.c_str(), "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    m_emulator->setDazzlerFrameHandler([this](const DazzlerFrame& frame) {
+        m_dazzlerCapture.submit(frame);
+    });
+
+    m_statusText = "Capturing Dazzler frames";
     updateStatusBar();
+    updateMenuState();
+}
+
+void MainWindow::stopDazzlerCapture() {
+    if (!m_dazzlerCapture.isCapturing()) return;
+
+    // Detach first so no frame arrives while the worker drains
+    m_emulator->setDazzlerFrameHandler(nullptr);
+    m_dazzlerCapture.stop();
+
+    std::string error = m_dazzlerCapture.lastError();
+    if (!error.empty()) {
+        m_statusText = "Dazzler capture failed: " + error;
+    } else {
+        m_statusText = "Dazzler capture saved (" + std::to_string(m_dazzlerCapture.framesWritten()) + " frames";
+        if (m_dazzlerCapture.framesDropped() > 0) {
+            m_statusText += ", " + std::to_string(m_dazzlerCapture.framesDropped()) + " dropped";
+        }
+        m_statusText += ")";
+    }
 }
 
 void MainWindow::onHelpTopics() {
@@ -926,11 +1567,31 @@ void MainWindow::onHelpAbout() {
 void MainWindow::updateMenuState() {
     bool running = m_emulator && m_emulator->isRunning();
 
+    // Re-enable whatever a finished save greyed; the checks below refine it
+    for (int id : ENGINE_COMMANDS) {
+        EnableMenuItem(m_menu, id, MF_ENABLED);
+    }
+
     EnableMenuItem(m_menu, ID_EMU_START, running ? MF_GRAYED : MF_ENABLED);
     EnableMenuItem(m_menu, ID_EMU_STOP, running ? MF_ENABLED : MF_GRAYED);
+    EnableMenuItem(m_menu, ID_EMU_PASTE, running ? MF_ENABLED : MF_GRAYED);
+    EnableMenuItem(m_menu, ID_EMU_REPLAY, (running || m_player) ? MF_GRAYED : MF_ENABLED);
+    ModifyMenuW(m_menu, ID_EMU_RECORD, MF_BYCOMMAND | MF_STRING, ID_EMU_RECORD,
+                m_recorder.isRecording() ? L"Stop Re&cording" : L"Start Re&cording...");
+    ModifyMenuW(m_menu, ID_VIEW_DAZZLER_CAPTURE, MF_BYCOMMAND | MF_STRING, ID_VIEW_DAZZLER_CAPTURE,
+                m_dazzlerCapture.isCapturing() ? L"Stop Dazzler &Capture" : L"Start Dazzler &Capture...");
+    EnableMenuItem(m_menu, ID_VIEW_DAZZLER_CAPTURE,
+                   (m_dazzlerEnabled || m_dazzlerCapture.isCapturing()) ? MF_ENABLED : MF_GRAYED);
     EnableMenuItem(m_menu, ID_ROM_EMU_AVW, running ? MF_GRAYED : MF_ENABLED);
     EnableMenuItem(m_menu, ID_ROM_EMU_ROMWBW, running ? MF_GRAYED : MF_ENABLED);
     EnableMenuItem(m_menu, ID_ROM_SBC_SIMH, running ? MF_GRAYED : MF_ENABLED);
+
+    // A disk save holds the engine; everything that needs it waits
+    if (m_diskTaskInProgress) {
+        for (int id : ENGINE_COMMANDS) {
+            EnableMenuItem(m_menu, id, MF_GRAYED);
+        }
+    }
 }
 
 void MainWindow::updateStatusBar() {
@@ -940,6 +1601,37 @@ void MainWindow::updateStatusBar() {
     }
 }
 
+void MainWindow::updateDiskStatus() {
+    if (!m_statusBar) return;
+
+    // e.g. "D0 1/16 slices 8.0 MB" - resident slices and bytes read from the file
+    std::string text;
+    for (int unit = 0; unit < 4; unit++) {
+        std::vector<DiskSliceStats> stats = m_emulator->getDiskSliceStats(unit);
+        if (stats.empty()) continue;
+
+        int resident = 0;
+        int slices = 0;
+        uint64_t bytesRead = 0;
+        for (const auto& s : stats) {
+            if (!s.prefix) {
+                slices++;
+                if (s.resident) resident++;
+            }
+            bytesRead += s.hostBytesRead;
+        }
+
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%sD%d %d/%d slices %.1f MB",
+                 text.empty() ? "" : "  ", unit, resident, slices,
+                 bytesRead / (1024.0 * 1024.0));
+        text += buf;
+    }
+
+    std::wstring wtext(text.begin(), text.end());
+    SendMessageW(m_statusBar, SB_SETTEXTW, 1, (LPARAM)wtext.c_str());
+}
+
 void MainWindow::checkROMMenuItem(int romId) {
     CheckMenuItem(m_menu, ID_ROM_EMU_AVW, romId == ID_ROM_EMU_AVW ? MF_CHECKED : MF_UNCHECKED);
     CheckMenuItem(m_menu, ID_ROM_EMU_ROMWBW, romId == ID_ROM_EMU_ROMWBW ? MF_CHECKED : MF_UNCHECKED);
@@ -955,11 +1647,22 @@ void MainWindow::checkFontMenuItem(int size) {
     CheckMenuItem(m_menu, ID_VIEW_FONT28, size == 28 ? MF_CHECKED : MF_UNCHECKED);
 }
 
-void MainWindow::onOutputChar(uint8_t ch) {
-    // This is called from the emulator - update terminal
+void MainWindow::checkTerminalSizeMenuItem(int rows, int cols) {
+    CheckMenuItem(m_menu, ID_VIEW_TERM_80X24, (rows == 24 && cols == 80) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_80X25, (rows == 25 && cols == 80) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_80X43, (rows == 43 && cols == 80) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_80X50, (rows == 50 && cols == 80) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_132X25, (rows == 25 && cols == 132) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_132X43, (rows == 43 && cols == 132) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(m_menu, ID_VIEW_TERM_132X60, (rows == 60 && cols == 132) ? MF_CHECKED : MF_UNCHECKED);
+}
+
+void MainWindow::onOutput(const uint8_t* data, size_t count) {
+    // Drained from the emulator's output ring - update terminal
     if (m_terminal) {
-        m_terminal->outputChar(ch);
+        m_terminal->output(data, count);
     }
+    m_recorder.recordOutput(data, count);
 }
 
 void MainWindow::onStatusChanged(const std::string& status) {
@@ -1118,6 +1821,9 @@ void MainWindow::applyConfig() {
     // Apply debug mode
     m_emulator->setDebug(cfg.debug);
 
+    // Journal mode must be set before disks are attached
+    m_emulator->setJournalDiskWrites(cfg.journalDiskWrites);
+
     // Apply boot string
     if (!cfg.bootString.empty()) {
         m_emulator->setBootString(cfg.bootString);
@@ -1128,6 +1834,19 @@ void MainWindow::applyConfig() {
         m_terminal->setFontSize(cfg.fontSize);
         checkFontMenuItem(cfg.fontSize);
     }
+    if (m_terminal) {
+        m_terminal->setScrollbackLines(cfg.scrollbackLines);
+
+        // Terminal geometry; HBIOS reports the same size to the guest
+        int oldRows = m_terminal->getRows();
+        int oldCols = m_terminal->getCols();
+        m_terminal->setGeometry(cfg.terminalRows, cfg.terminalCols);
+        m_emulator->setTextSize(m_terminal->getRows(), m_terminal->getCols());
+        checkTerminalSizeMenuItem(m_terminal->getRows(), m_terminal->getCols());
+        if (m_terminal->getRows() != oldRows || m_terminal->getCols() != oldCols) {
+            fitWindowToTerminal();
+        }
+    }
 
     // Load disks
     for (int i = 0; i < 4; i++) {
@@ -1147,26 +1866,11 @@ void MainWindow::applyConfig() {
         }
     }
 
-    // Apply Dazzler settings (if any configured)
-    if (!cfg.dazzlers.empty()) {
-        const auto& daz = cfg.dazzlers[0];
-        if (daz.enabled) {
-            m_dazzlerEnabled = true;
-            m_emulator->enableDazzler(daz.port, daz.scale);
-
-            // Create Dazzler window
-            if (!m_dazzlerWindow) {
-                m_dazzlerWindow = std::make_unique<DazzlerWindow>();
-                RECT mainRect;
-                GetWindowRect(m_hwnd, &mainRect);
-                m_dazzlerWindow->create(m_hwnd, mainRect.right + 10, mainRect.top, daz.scale);
-            }
-            if (m_dazzlerWindow && m_emulator->getDazzler()) {
-                m_dazzlerWindow->setDazzler(m_emulator->getDazzler());
-                m_dazzlerWindow->show(true);
-            }
-            CheckMenuItem(m_menu, ID_VIEW_DAZZLER, MF_CHECKED);
-        }
+    // Apply Dazzler settings: every card flagged enabled gets its window
+    if (!m_dazzlerEnabled && std::any_of(cfg.dazzlers.begin(), cfg.dazzlers.end(),
+                                         [](const config::DazzlerConfig& d) { return d.enabled; })) {
+        openDazzlers(true);
+        CheckMenuItem(m_menu, ID_VIEW_DAZZLER, m_dazzlerEnabled ? MF_CHECKED : MF_UNCHECKED);
     }
 }
 
@@ -1195,22 +1899,19 @@ void MainWindow::updateConfigFromState() {
     // Capture font size
     if (m_terminal) {
         cfg.fontSize = m_terminal->getFontSize();
+        cfg.terminalRows = m_terminal->getRows();
+        cfg.terminalCols = m_terminal->getCols();
     }
 
     // Capture disk paths (already updated when disks are loaded)
 
-    // Capture Dazzler state
-    if (m_dazzlerEnabled) {
-        if (cfg.dazzlers.empty()) {
-            cfg.dazzlers.push_back(config::DazzlerConfig{});
-        }
-        cfg.dazzlers[0].enabled = true;
-        if (m_emulator->getDazzler()) {
-            cfg.dazzlers[0].port = m_emulator->getDazzler()->getBasePort();
-            cfg.dazzlers[0].scale = m_emulator->getDazzler()->getScale();
+    // Capture Dazzler state: a card is enabled if it is running now
+    for (auto& daz : cfg.dazzlers) {
+        Dazzler* dazzler = m_emulator->getDazzler(daz.port);
+        daz.enabled = dazzler != nullptr;
+        if (dazzler) {
+            daz.scale = dazzler->getScale();
         }
-    } else if (!cfg.dazzlers.empty()) {
-        cfg.dazzlers[0].enabled = false;
     }
 }
 
@@ -9,7 +9,13 @@
 #include <windows.h>
 #include <memory>
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include "Config.h"
+#include "SessionRecording.h"
+#include "DazzlerCapture.h"
 
 class TerminalView;
 class EmulatorEngine;
@@ -47,26 +53,50 @@ private:
     void onFileLoadDisk(int unit);
     void onFileSaveDisk(int unit);
     void onFileSaveAllDisks();
+    void startDiskSave(std::vector<std::pair<int, std::string>> jobs);
+    // Run a save or image conversion on the disk worker: work reports
+    // progress and returns the status text, or "" on failure
+    using DiskTask = std::function<std::string(const std::function<void(size_t done, size_t total)>& progress)>;
+    void startDiskTask(const std::string& label, const std::string& failure, DiskTask work);
+    void onFileCompressDisk();
+    void onFileExpandDisk();
+    void onFileDedupDisk();
+    void onFileCloneDisk();
     void onSelectROM(int romId);
     void onEmulatorStart();
     void onEmulatorStop();
     void onEmulatorReset();
+    void onEmulatorPaste();
+    void feedPaste();
+    void onEmulatorRecord();
+    void onEmulatorReplay();
+    void setReplaySpeed(int menuId);
+    void pumpReplay();
+    void endReplay();
     void onEmulatorSettings();
     void startEmulator();
     void downloadAndStartWithDefaults();
     void onViewFontSize(int size);
+    void onViewTerminalSize(int rows, int cols);
     void onViewDazzler();
+    void openDazzlers(bool flaggedOnly);
+    void closeDazzlers();
+    void onViewDazzlerCapture();
+    void stopDazzlerCapture();
     void onHelpTopics();
     void onHelpAbout();
 
     // Update menu state
     void updateMenuState();
     void updateStatusBar();
+    void updateDiskStatus();
     void checkROMMenuItem(int romId);
     void checkFontMenuItem(int size);
+    void checkTerminalSizeMenuItem(int rows, int cols);
+    void fitWindowToTerminal();
 
     // Callbacks from emulator
-    void onOutputChar(uint8_t ch);
+    void onOutput(const uint8_t* data, size_t count);
     void onStatusChanged(const std::string& status);
 
     // Find and load ROM/disk files
@@ -94,7 +124,7 @@ private:
     std::unique_ptr<TerminalView> m_terminal;
     std::unique_ptr<EmulatorEngine> m_emulator;
     std::unique_ptr<DiskCatalog> m_diskCatalog;
-    std::unique_ptr<DazzlerWindow> m_dazzlerWindow;
+    std::vector<std::unique_ptr<DazzlerWindow>> m_dazzlerWindows;  // One per running card
 
     int m_currentRomId = 0;         // For menu checkmark tracking
     std::string m_statusText = "Ready";
@@ -102,9 +132,35 @@ private:
     // Runtime Dazzler state (config is source of truth for persistence)
     bool m_dazzlerEnabled = false;
 
+    // Dazzler frames to PNG/GIF; fed on the emulator thread
+    DazzlerCapture m_dazzlerCapture;
+
+    static constexpr int DISK_STATUS_WIDTH = 340;  // Status bar part for slice stats
+
     UINT_PTR m_emulatorTimer = 0;
     static constexpr int TIMER_INTERVAL_MS = 10;  // 100 Hz
 
     // Track if initial disk downloads are in progress
     bool m_downloadingDisks = false;
+
+    // Clipboard text not yet accepted by the emulator's input queue
+    std::string m_pasteBuffer;
+    size_t m_pasteOffset = 0;
+    static constexpr size_t PASTE_CHUNK = 4096;  // Offered to the input queue per tick
+
+    // Session recording (asciicast) and replay without the CPU
+    SessionRecorder m_recorder;
+    std::unique_ptr<SessionPlayer> m_player;
+    double m_replaySpeed = 1.0;     // 0 = as fast as the terminal takes it
+    std::chrono::steady_clock::time_point m_replayStart;
+    static constexpr size_t REPLAY_CHUNK = 4 * 1024 * 1024;  // Fed per tick at most
+
+    // Disk saves and image conversions run one at a time on a worker; a
+    // save pauses execution until it finishes, and commands needing the
+    // engine (see ENGINE_COMMANDS) wait for either
+    std::thread m_diskTaskThread;
+    std::atomic<bool> m_diskTaskInProgress{false};
+    std::string m_diskTaskLabel;    // "Saving disk", shown with the percentage
+    std::string m_diskTaskFailure;  // Message box text if the task fails
+    bool m_closePending = false;    // WM_CLOSE arrived during a task
 };
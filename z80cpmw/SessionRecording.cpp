@@ -0,0 +1,271 @@
+/*
+ * SessionRecording.cpp - Terminal Session Recording and Replay Implementation
+ *
+ * Built without the precompiled header so it stays free of Windows headers.
+ */
+
+#include "SessionRecording.h"
+#include "include/nlohmann/json.hpp"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+using json = nlohmann::json;
+
+//=============================================================================
+// Recorder
+//=============================================================================
+
+SessionRecorder::~SessionRecorder() {
+    stop();
+}
+
+bool SessionRecorder::start(const std::string& path, int cols, int rows, bool recordInput, std::string& error) {
+    stop();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file) {
+        error = "Cannot create " + path;
+        return false;
+    }
+    setvbuf(m_file, nullptr, _IOFBF, 64 * 1024);
+
+    json header = {
+        {"version", 2},
+        {"width", cols},
+        {"height", rows},
+        {"timestamp", (int64_t)time(nullptr)},
+        {"env", {{"TERM", "vt100"}}}
+    };
+    std::string line = header.dump() + "\n";
+    fwrite(line.data(), 1, line.size(), m_file);
+
+    m_recordInput = recordInput;
+    m_startTime = std::chrono::steady_clock::now();
+    m_pending = Batch();
+    m_stopping = false;
+    m_writer = std::thread(&SessionRecorder::writerThread, this);
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (!m_file) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+void SessionRecorder::recordOutput(const uint8_t* data, size_t count) {
+    record('o', data, count);
+}
+
+void SessionRecorder::recordInput(const char* data, size_t count) {
+    if (m_recordInput) {
+        record('i', (const uint8_t*)data, count);
+    }
+}
+
+void SessionRecorder::record(char type, const uint8_t* data, size_t count) {
+    if (!m_file || count == 0) return;
+
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    // Only a copy under the lock; formatting and I/O happen on the writer
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.events.push_back({ time, type, m_pending.bytes.size(), count });
+    m_pending.bytes.insert(m_pending.bytes.end(), data, data + count);
+}
+
+void SessionRecorder::writerThread() {
+    Batch batch;
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, FLUSH_INTERVAL, [this] { return m_stopping; });
+            stopping = m_stopping;
+
+            // Swap so the UI thread keeps appending into the old capacity
+            std::swap(batch, m_pending);
+            m_pending.events.clear();
+            m_pending.bytes.clear();
+        }
+
+        if (!batch.events.empty()) {
+            writeBatch(batch);
+            fflush(m_file);
+        }
+        if (stopping) break;
+    }
+}
+
+void SessionRecorder::writeBatch(const Batch& batch) {
+    static const char HEX[] = "0123456789abcdef";
+
+    for (const Event& event : batch.events) {
+        char prefix[48];
+        snprintf(prefix, sizeof(prefix), "[%.6f, \"%c\", \"", event.time, event.type);
+        m_line = prefix;
+
+        // JSON string of the raw bytes; anything outside printable ASCII is
+        // escaped as its Latin-1 code point so the file stays valid UTF-8
+        const uint8_t* p = batch.bytes.data() + event.offset;
+        for (size_t i = 0; i < event.length; i++) {
+            uint8_t ch = p[i];
+            switch (ch) {
+            case '"':  m_line += "\\\""; break;
+            case '\\': m_line += "\\\\"; break;
+            case '\n': m_line += "\\n"; break;
+            case '\r': m_line += "\\r"; break;
+            case '\t': m_line += "\\t"; break;
+            case '\b': m_line += "\\b"; break;
+            default:
+                if (ch >= 0x20 && ch < 0x7F) {
+                    m_line += (char)ch;
+                } else {
+                    m_line += "\\u00";
+                    m_line += HEX[ch >> 4];
+                    m_line += HEX[ch & 0x0F];
+                }
+                break;
+            }
+        }
+        m_line += "\"]\n";
+        fwrite(m_line.data(), 1, m_line.size(), m_file);
+    }
+}
+
+//=============================================================================
+// Player
+//=============================================================================
+
+// Event data back to bytes: code points up to U+00FF map to themselves,
+// anything wider (a recording from another terminal) becomes '?'
+static void decodeEventData(const std::string& utf8, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < utf8.size()) {
+        uint8_t lead = (uint8_t)utf8[i];
+        uint32_t cp;
+        size_t extra;
+        if (lead < 0x80) {
+            cp = lead;
+            extra = 0;
+        } else if ((lead & 0xE0) == 0xC0) {
+            cp = lead & 0x1F;
+            extra = 1;
+        } else if ((lead & 0xF0) == 0xE0) {
+            cp = lead & 0x0F;
+            extra = 2;
+        } else {
+            cp = lead & 0x07;
+            extra = 3;
+        }
+        i++;
+        for (size_t k = 0; k < extra && i < utf8.size(); k++, i++) {
+            cp = (cp << 6) | ((uint8_t)utf8[i] & 0x3F);
+        }
+        out.push_back(cp <= 0xFF ? (uint8_t)cp : (uint8_t)'?');
+    }
+}
+
+bool SessionPlayer::load(const std::string& path, std::string& error) {
+    m_events.clear();
+    m_data.clear();
+    m_next = 0;
+
+    std::ifstream file(path);
+    if (!file) {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        error = "Empty recording";
+        return false;
+    }
+
+    double idleLimit = 0;
+    try {
+        json header = json::parse(line);
+        if (header.value("version", 0) != 2) {
+            error = "Not an asciicast v2 recording";
+            return false;
+        }
+        m_cols = header.value("width", 80);
+        m_rows = header.value("height", 25);
+        idleLimit = header.value("idle_time_limit", 0.0);
+
+        // Gaps longer than the idle limit are shortened to it, as players do
+        double lastRecorded = 0;
+        double shifted = 0;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            json event = json::parse(line);
+            if (!event.is_array() || event.size() < 3 || event[1] != "o") continue;
+
+            double time = event[0].get<double>();
+            double gap = std::max(0.0, time - lastRecorded);
+            if (idleLimit > 0 && gap > idleLimit) gap = idleLimit;
+            lastRecorded = time;
+            shifted += gap;
+
+            size_t offset = m_data.size();
+            decodeEventData(event[2].get<std::string>(), m_data);
+            if (m_data.size() > offset) {
+                m_events.push_back({ shifted, offset, m_data.size() - offset });
+            }
+        }
+    } catch (const json::exception& e) {
+        error = std::string("Bad recording: ") + e.what();
+        m_events.clear();
+        m_data.clear();
+        return false;
+    }
+    return true;
+}
+
+void SessionPlayer::start(double speed) {
+    m_next = 0;
+    m_speed = speed;
+    m_startTime = std::chrono::steady_clock::now();
+}
+
+void SessionPlayer::setSpeed(double speed) {
+    // Rebase the clock so the last event handed over stays "now"
+    double position = m_next > 0 ? m_events[m_next - 1].time : 0.0;
+    m_speed = speed;
+    if (speed > 0) {
+        m_startTime = std::chrono::steady_clock::now() -
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(position / speed));
+    }
+}
+
+void SessionPlayer::pump(const OutputFunc& output, size_t maxBytes) {
+    double due = 0;
+    if (m_speed > 0) {
+        due = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count() * m_speed;
+    }
+
+    // Events are contiguous in m_data, so everything due goes out in one call
+    size_t first = m_next;
+    size_t bytes = 0;
+    while (m_next < m_events.size() && bytes < maxBytes &&
+           (m_speed <= 0 || m_events[m_next].time <= due)) {
+        bytes += m_events[m_next].length;
+        m_next++;
+    }
+    if (bytes) {
+        output(m_data.data() + m_events[first].offset, bytes);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * SessionRecording.h - Terminal Session Recording and Replay (asciicast v2)
+ *
+ * SessionRecorder captures the guest output stream, and optionally what was
+ * typed, as an asciicast v2 file: a JSON header line followed by one
+ * [seconds, "o" | "i", data] event per line. Times come from the monotonic
+ * clock. The UI thread only appends bytes to a memory buffer; a writer thread
+ * formats the events and writes them in batches.
+ *
+ * SessionPlayer loads a recording and hands its output events back at the
+ * recorded pace, a multiple of it, or as fast as the terminal takes them -
+ * no CPU, so a replay reproduces a session and benchmarks the terminal
+ * pipeline with real guest traffic.
+ *
+ * Portable: no Windows headers.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SessionRecorder {
+public:
+    ~SessionRecorder();
+
+    // Create the file and write the header; false with error set on failure
+    bool start(const std::string& path, int cols, int rows, bool recordInput, std::string& error);
+
+    // Write out everything captured so far and close the file
+    void stop();
+
+    bool isRecording() const { return m_file != nullptr; }
+
+    // UI thread: capture output shown on the terminal / keyboard input
+    void recordOutput(const uint8_t* data, size_t count);
+    void recordInput(const char* data, size_t count);
+
+private:
+    struct Event {
+        double time;        // Seconds since start()
+        char type;          // 'o' or 'i'
+        size_t offset;      // Into the batch's byte buffer
+        size_t length;
+    };
+
+    struct Batch {
+        std::vector<Event> events;
+        std::vector<uint8_t> bytes;
+    };
+
+    void record(char type, const uint8_t* data, size_t count);
+    void writerThread();
+    void writeBatch(const Batch& batch);
+
+    // Flush to disk at least this often while recording
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{250};
+
+    FILE* m_file = nullptr;
+    bool m_recordInput = false;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    Batch m_pending;                // Filled by the UI thread
+    bool m_stopping = false;
+    std::thread m_writer;
+
+    std::string m_line;             // Writer's formatting buffer
+};
+
+class SessionPlayer {
+public:
+    using OutputFunc = std::function<void(const uint8_t* data, size_t count)>;
+
+    // Parse a recording; false with error set on failure
+    bool load(const std::string& path, std::string& error);
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    double duration() const { return m_events.empty() ? 0.0 : m_events.back().time; }
+    size_t outputBytes() const { return m_data.size(); }
+
+    // Rewind and start the clock; speed multiplies the recorded pace,
+    // 0 replays as fast as the output is taken
+    void start(double speed);
+
+    // Change speed without losing the playback position
+    void setSpeed(double speed);
+
+    // Hand over the output that is due, at most maxBytes of it (whole
+    // events; a single larger event still goes out in one piece)
+    void pump(const OutputFunc& output, size_t maxBytes);
+
+    bool finished() const { return m_next >= m_events.size(); }
+
+private:
+    struct Event {
+        double time;
+        size_t offset;
+        size_t length;
+    };
+
+    int m_cols = 80;
+    int m_rows = 25;
+    std::vector<Event> m_events;    // Output events only
+    std::vector<uint8_t> m_data;
+
+    size_t m_next = 0;
+    double m_speed = 1.0;
+    std::chrono::steady_clock::time_point m_startTime;
+};
@@ -79,6 +79,9 @@ void SettingsDialogWx::createControls() {
     // Warn on manifest writes checkbox
     m_warnManifestCheck = new wxCheckBox(this, wxID_ANY, "Warn on Downloaded Disk Writes");
 
+    // Journal disk writes checkbox
+    m_journalCheck = new wxCheckBox(this, wxID_ANY, "Journal Disk Writes (crash-safe)");
+
     // Dazzler controls
     m_dazzlerEnabledCheck = new wxCheckBox(this, ID_DAZZLER_ENABLED, "Enable Dazzler Graphics Card");
     m_dazzlerPortLabel = new wxStaticText(this, wxID_ANY, "Port (hex):");
@@ -148,7 +151,10 @@ void SettingsDialogWx::layoutControls() {
     paddedSizer->Add(m_debugCheck, 0, wxBOTTOM, 8);
 
     // Warn on manifest writes checkbox
-    paddedSizer->Add(m_warnManifestCheck, 0, wxBOTTOM, 15);
+    paddedSizer->Add(m_warnManifestCheck, 0, wxBOTTOM, 8);
+
+    // Journal disk writes checkbox
+    paddedSizer->Add(m_journalCheck, 0, wxBOTTOM, 15);
 
     // Separator before Dazzler
     paddedSizer->Add(new wxStaticLine(this), 0, wxEXPAND | wxBOTTOM, 15);
@@ -278,6 +284,9 @@ void SettingsDialogWx::loadSettings() {
     // Warn on manifest writes
     m_warnManifestCheck->SetValue(m_settings.warnManifestWrites);
 
+    // Journal disk writes
+    m_journalCheck->SetValue(m_settings.journalDiskWrites);
+
     // Dazzler settings
     m_dazzlerEnabledCheck->SetValue(m_settings.dazzlerEnabled);
     m_dazzlerPortSpin->SetValue(m_settings.dazzlerPort);
@@ -315,6 +324,9 @@ void SettingsDialogWx::saveSettings() {
     // Warn on manifest writes
     m_settings.warnManifestWrites = m_warnManifestCheck->GetValue();
 
+    // Journal disk writes
+    m_settings.journalDiskWrites = m_journalCheck->GetValue();
+
     // Dazzler settings
     m_settings.dazzlerEnabled = m_dazzlerEnabledCheck->GetValue();
     m_settings.dazzlerPort = m_dazzlerPortSpin->GetValue();
@@ -325,7 +337,7 @@ void SettingsDialogWx::onBrowseDisk(wxCommandEvent& event) {
     int unit = event.GetId() - ID_BROWSE_DISK0;
 
     wxFileDialog dlg(this, "Select Disk Image", "", "",
-                     "Disk Images (*.img)|*.img|All Files (*.*)|*.*",
+                     "Disk Images (*.img;*.imz;*.imgref)|*.img;*.imz;*.imgref|All Files (*.*)|*.*",
                      wxFD_OPEN | wxFD_FILE_MUST_EXIST);
 
     if (dlg.ShowModal() == wxID_OK) {
@@ -23,6 +23,7 @@ struct WxEmulatorSettings {
     std::string diskFiles[4];
     bool debugMode = false;
     bool warnManifestWrites = true;         // Warn when writing to downloaded catalog disks
+    bool journalDiskWrites = false;         // Crash-safe disk writes (applies on next disk load)
     bool clearBootConfigRequested = false;  // Set when user clicks "Clear Boot Config"
 
     // Dazzler settings
@@ -73,6 +74,7 @@ private:
     wxButton* m_clearBootBtn;
     wxCheckBox* m_debugCheck;
     wxCheckBox* m_warnManifestCheck;
+    wxCheckBox* m_journalCheck;
 
     // Dazzler controls
     wxCheckBox* m_dazzlerEnabledCheck;
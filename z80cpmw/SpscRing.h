@@ -0,0 +1,120 @@
+/*
+ * SpscRing.h - Lock-Free Single-Producer/Single-Consumer Ring Buffer
+ *
+ * One thread pushes, one thread pops; neither ever blocks or allocates.
+ * Each side keeps a cached copy of the other side's index so the shared
+ * cache line is only touched when the cached view says full/empty.
+ *
+ * The consumer can read in place: readSpan() returns the contiguous run of
+ * queued elements (up to the wrap point) and consume() releases it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    static constexpr size_t CAPACITY = Capacity;
+
+    //-------------------------------------------------------------------------
+    // Producer side
+    //-------------------------------------------------------------------------
+
+    bool push(const T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) return false;
+        }
+        m_buffer[head & MASK] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Push as many as fit; returns the number pushed
+    size_t push(const T* values, size_t count) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t space = Capacity - (head - m_cachedTail);
+        if (space < count) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            space = Capacity - (head - m_cachedTail);
+        }
+        if (count > space) count = space;
+
+        size_t start = head & MASK;
+        size_t first = count < Capacity - start ? count : Capacity - start;
+        memcpy(&m_buffer[start], values, first * sizeof(T));
+        memcpy(&m_buffer[0], values + first, (count - first) * sizeof(T));
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    // Consumer side
+    //-------------------------------------------------------------------------
+
+    bool pop(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) return false;
+        }
+        value = m_buffer[tail & MASK];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Contiguous queued elements starting at the read position (0 if empty)
+    size_t readSpan(const T** data) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        size_t count = m_cachedHead - tail;
+        size_t start = tail & MASK;
+        if (count > Capacity - start) count = Capacity - start;
+        *data = &m_buffer[start];
+        return count;
+    }
+
+    // Release elements returned by readSpan()
+    void consume(size_t count) {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Queued elements; seen from the producer it may over-count, so the free
+    // space it implies is a safe lower bound
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_relaxed) == m_head.load(std::memory_order_acquire);
+    }
+
+    // Drop everything queued (consumer side). The cached head moves too, or
+    // pop() would trust a stale one behind the new tail.
+    void clear() {
+        size_t head = m_head.load(std::memory_order_acquire);
+        m_cachedHead = head;
+        m_tail.store(head, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    T m_buffer[Capacity];
+
+    // Producer-owned line
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+
+    // Consumer-owned line
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+};
@@ -0,0 +1,143 @@
+/*
+ * TerminalRenderer.cpp - Glyph Atlas Software Renderer Implementation
+ *
+ * Built without the precompiled header so it stays free of Windows headers.
+ */
+
+#include "TerminalRenderer.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TERMINAL_RENDERER_SSE2 1
+#endif
+
+uint32_t TerminalRenderer::cgaColor(uint8_t index) {
+    static const uint32_t palette[16] = {
+        0x000000,  // 0: Black
+        0x0000AA,  // 1: Blue
+        0x00AA00,  // 2: Green
+        0x00AAAA,  // 3: Cyan
+        0xAA0000,  // 4: Red
+        0xAA00AA,  // 5: Magenta
+        0xAA5500,  // 6: Brown
+        0xAAAAAA,  // 7: Light gray
+        0x555555,  // 8: Dark gray
+        0x5555FF,  // 9: Light blue
+        0x55FF55,  // 10: Light green
+        0x55FFFF,  // 11: Light cyan
+        0xFF5555,  // 12: Light red
+        0xFF55FF,  // 13: Light magenta
+        0xFFFF55,  // 14: Yellow
+        0xFFFFFF,  // 15: White
+    };
+    return palette[index & 0x0F];
+}
+
+void TerminalRenderer::setRasterizer(std::unique_ptr<GlyphRasterizer> rasterizer) {
+    m_rasterizer = std::move(rasterizer);
+    m_colorized.clear();
+    m_coverage.clear();
+    m_cellWidth = 0;
+    m_cellHeight = 0;
+    if (!m_rasterizer) return;
+
+    m_cellWidth = m_rasterizer->cellWidth();
+    m_cellHeight = m_rasterizer->cellHeight();
+
+    // Rasterize every glyph once for this font
+    size_t glyphBytes = (size_t)m_cellWidth * m_cellHeight;
+    m_coverage.assign(glyphBytes * GLYPH_COUNT, 0);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        m_rasterizer->rasterize((uint8_t)(FIRST_GLYPH + i), &m_coverage[i * glyphBytes]);
+    }
+    m_colorized.resize(256);
+
+    // Cell size may have changed
+    resize(m_rows, m_cols);
+}
+
+void TerminalRenderer::resize(int rows, int cols) {
+    m_rows = rows;
+    m_cols = cols;
+    m_pixels.assign((size_t)width() * height(), 0);
+}
+
+const uint32_t* TerminalRenderer::colorizedAtlas(uint8_t attr) {
+    std::vector<uint32_t>& atlas = m_colorized[attr];
+    if (!atlas.empty()) return atlas.data();
+
+    // Blend once per pair; every later use of the pair is a straight copy
+    uint32_t fc = cgaColor(attr & 0x0F);
+    uint32_t bc = cgaColor(attr >> 4);
+    int fr = (fc >> 16) & 0xFF, fgc = (fc >> 8) & 0xFF, fb = fc & 0xFF;
+    int br = (bc >> 16) & 0xFF, bgc = (bc >> 8) & 0xFF, bb = bc & 0xFF;
+
+    uint32_t blend[256];
+    for (int a = 0; a < 256; a++) {
+        uint32_t r = (uint32_t)(br + (fr - br) * a / 255);
+        uint32_t g = (uint32_t)(bgc + (fgc - bgc) * a / 255);
+        uint32_t b = (uint32_t)(bb + (fb - bb) * a / 255);
+        blend[a] = (r << 16) | (g << 8) | b;
+    }
+
+    atlas.resize(m_coverage.size());
+    for (size_t i = 0; i < m_coverage.size(); i++) {
+        atlas[i] = blend[m_coverage[i]];
+    }
+    return atlas.data();
+}
+
+// Copy one glyph scanline (a few dozen bytes) into the framebuffer
+static inline void copySpan(uint32_t* dst, const uint32_t* src, int count) {
+#ifdef TERMINAL_RENDERER_SSE2
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = src[i];
+    }
+#else
+    memcpy(dst, src, (size_t)count * sizeof(uint32_t));
+#endif
+}
+
+void TerminalRenderer::renderRow(int row, const TerminalCell* cells) {
+    if (row < 0 || row >= m_rows || m_coverage.empty()) return;
+
+    const int stride = width();
+    const size_t glyphPixels = (size_t)m_cellWidth * m_cellHeight;
+    uint32_t* rowTop = m_pixels.data() + (size_t)row * m_cellHeight * stride;
+
+    // Runs of cells with the same colors share one atlas lookup
+    int col = 0;
+    while (col < m_cols) {
+        uint8_t attr = cellAttr(cells[col]);
+        const uint32_t* atlas = colorizedAtlas(attr);
+
+        for (; col < m_cols && cellAttr(cells[col]) == attr; col++) {
+            int ch = cellChar(cells[col]);
+            int glyph = (ch >= FIRST_GLYPH && ch < FIRST_GLYPH + GLYPH_COUNT) ? ch - FIRST_GLYPH : 0;
+            const uint32_t* src = atlas + glyph * glyphPixels;
+            uint32_t* dst = rowTop + col * m_cellWidth;
+            for (int y = 0; y < m_cellHeight; y++) {
+                copySpan(dst, src, m_cellWidth);
+                src += m_cellWidth;
+                dst += stride;
+            }
+        }
+    }
+}
+
+void TerminalRenderer::fillRect(int x, int y, int w, int h, uint32_t color) {
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + w, width());
+    int y1 = std::min(y + h, height());
+    for (int py = y0; py < y1; py++) {
+        uint32_t* dst = m_pixels.data() + (size_t)py * width();
+        std::fill(dst + x0, dst + x1, color);
+    }
+}
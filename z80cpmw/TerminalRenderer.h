@@ -0,0 +1,84 @@
+/*
+ * TerminalRenderer.h - Glyph Atlas Software Renderer for the Terminal
+ *
+ * Composes the terminal cell grid into a 32-bit framebuffer without going
+ * through text APIs per frame. Each glyph is rasterized once per font into
+ * an 8-bit coverage atlas; a colorized copy of the atlas is built lazily the
+ * first time a foreground/background pair is used, after which drawing a
+ * cell is one row copy per scanline.
+ *
+ * Portable: no Windows headers. The font comes from a GlyphRasterizer (GDI
+ * on Windows, see TerminalView.cpp); a headless build can plug in its own and
+ * read the framebuffer directly.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Terminal cell: character in the low byte, CGA attribute (background << 4 |
+// foreground) in the high byte. Packed so a 132x60 screen is 16 KB and a
+// row compare or fill is a plain 16-bit loop.
+using TerminalCell = uint16_t;
+
+constexpr TerminalCell BLANK_CELL = 0x0720;  // Space, white on black
+
+inline TerminalCell makeCell(uint8_t ch, uint8_t attr) { return (TerminalCell)(ch | (attr << 8)); }
+inline uint8_t cellChar(TerminalCell cell) { return (uint8_t)(cell & 0xFF); }
+inline uint8_t cellAttr(TerminalCell cell) { return (uint8_t)(cell >> 8); }
+
+// Produces glyph coverage for one font (0 = background, 255 = foreground)
+class GlyphRasterizer {
+public:
+    virtual ~GlyphRasterizer() = default;
+    virtual int cellWidth() const = 0;
+    virtual int cellHeight() const = 0;
+
+    // Fill cellWidth() * cellHeight() coverage bytes, row-major
+    virtual void rasterize(uint8_t ch, uint8_t* coverage) = 0;
+};
+
+class TerminalRenderer {
+public:
+    static constexpr int FIRST_GLYPH = 0x20;
+    static constexpr int GLYPH_COUNT = 0x7F - FIRST_GLYPH;  // Printable ASCII
+
+    // Replace the font; rebuilds the coverage atlas and drops colorized ones
+    void setRasterizer(std::unique_ptr<GlyphRasterizer> rasterizer);
+
+    // Size the framebuffer for a grid of cells (contents are undefined)
+    void resize(int rows, int cols);
+
+    // Compose one row of cells
+    void renderRow(int row, const TerminalCell* cells);
+
+    // Solid rectangle in pixels, e.g. the cursor (clipped)
+    void fillRect(int x, int y, int width, int height, uint32_t color);
+
+    int cellWidth() const { return m_cellWidth; }
+    int cellHeight() const { return m_cellHeight; }
+    int width() const { return m_cols * m_cellWidth; }
+    int height() const { return m_rows * m_cellHeight; }
+
+    // Top-down 0x00RRGGBB pixels, width() per row (BI_RGB 32-bit layout)
+    const uint32_t* pixels() const { return m_pixels.data(); }
+
+    // CGA palette as 0x00RRGGBB
+    static uint32_t cgaColor(uint8_t index);
+
+private:
+    const uint32_t* colorizedAtlas(uint8_t attr);
+
+    std::unique_ptr<GlyphRasterizer> m_rasterizer;
+    int m_cellWidth = 0;
+    int m_cellHeight = 0;
+    int m_rows = 0;
+    int m_cols = 0;
+
+    std::vector<uint8_t> m_coverage;                     // GLYPH_COUNT glyphs
+    std::vector<std::vector<uint32_t>> m_colorized;      // [attr], lazy
+    std::vector<uint32_t> m_pixels;
+};
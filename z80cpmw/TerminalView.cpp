@@ -8,7 +8,64 @@
 static const wchar_t* TERMINAL_CLASS = L"Z80CPM_Terminal";
 static bool g_classRegistered = false;
 
-TerminalView::TerminalView() {
+// Rasterizes the terminal font through GDI, white on black into a DIB, so
+// the green channel is the glyph coverage (ClearType fringes included)
+class GdiGlyphRasterizer : public GlyphRasterizer {
+public:
+    GdiGlyphRasterizer(HFONT font, int cellWidth, int cellHeight)
+        : m_font(font), m_cellWidth(cellWidth), m_cellHeight(cellHeight) {}
+
+    int cellWidth() const override { return m_cellWidth; }
+    int cellHeight() const override { return m_cellHeight; }
+
+    void rasterize(uint8_t ch, uint8_t* coverage) override {
+        memset(coverage, 0, (size_t)m_cellWidth * m_cellHeight);
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = m_cellWidth;
+        bmi.bmiHeader.biHeight = -m_cellHeight;  // Top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = nullptr;
+        HDC dc = CreateCompatibleDC(nullptr);
+        HBITMAP bitmap = CreateDIBSection(dc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (!dc || !bitmap) {
+            if (bitmap) DeleteObject(bitmap);
+            if (dc) DeleteDC(dc);
+            return;
+        }
+
+        HBITMAP oldBitmap = (HBITMAP)SelectObject(dc, bitmap);
+        HFONT oldFont = (HFONT)SelectObject(dc, m_font);
+        SetTextColor(dc, RGB(255, 255, 255));
+        SetBkColor(dc, RGB(0, 0, 0));
+        RECT cell = { 0, 0, m_cellWidth, m_cellHeight };
+        char text = (char)ch;
+        ExtTextOutA(dc, 0, 0, ETO_OPAQUE | ETO_CLIPPED, &cell, &text, 1, nullptr);
+        GdiFlush();
+
+        const uint32_t* pixels = (const uint32_t*)bits;
+        for (int i = 0; i < m_cellWidth * m_cellHeight; i++) {
+            coverage[i] = (uint8_t)((pixels[i] >> 8) & 0xFF);
+        }
+
+        SelectObject(dc, oldFont);
+        SelectObject(dc, oldBitmap);
+        DeleteObject(bitmap);
+        DeleteDC(dc);
+    }
+
+private:
+    HFONT m_font;
+    int m_cellWidth;
+    int m_cellHeight;
+};
+
+TerminalView::TerminalView() : m_parser(*this) {
+    setScrollbackLines(DEFAULT_SCROLLBACK);
     clear();
 }
 
@@ -58,6 +115,15 @@ bool TerminalView::create(HWND parent, int x, int y, int width, int height) {
     // Start cursor blink timer
     m_cursorTimer = SetTimer(m_hwnd, 1, 500, nullptr);
 
+    // Pace burst-mode frames to the display
+    HDC hdc = GetDC(m_hwnd);
+    int refreshHz = GetDeviceCaps(hdc, VREFRESH);
+    ReleaseDC(m_hwnd, hdc);
+    if (refreshHz > 1) {
+        m_frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / refreshHz));
+    }
+
     return true;
 }
 
@@ -110,54 +176,122 @@ void TerminalView::createFont() {
 
         SelectObject(hdc, oldFont);
         ReleaseDC(m_hwnd, hdc);
+
+        // Glyphs are rasterized once per font; painting only copies pixels
+        m_renderer.setRasterizer(std::make_unique<GdiGlyphRasterizer>(m_font, m_charWidth, m_charHeight));
+        m_renderer.resize(m_rows, m_cols);
+        m_fullRedraw = true;
     }
 }
 
 void TerminalView::clear() {
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            m_cells[row][col] = TerminalCell();
-        }
+    // Clears the screen; scrollback is kept
+    for (int row = 0; row < m_rows; row++) {
+        TerminalCell* cells = screenRow(row);
+        std::fill(cells, cells + m_cols, BLANK_CELL);
     }
     m_cursorRow = 0;
     m_cursorCol = 0;
-    m_escapeState = EscapeState::Normal;
-    m_escapeParams.clear();
-    m_escapeCurrentParam.clear();
+    m_parser.reset();
     m_currentAttr = 0x07;
     invalidate();
 }
 
 void TerminalView::setCursor(int row, int col) {
-    m_cursorRow = std::max(0, std::min(row, ROWS - 1));
-    m_cursorCol = std::max(0, std::min(col, COLS - 1));
-    invalidate();
+    m_cursorRow = std::max(0, std::min(row, m_rows - 1));
+    m_cursorCol = std::max(0, std::min(col, m_cols - 1));
 }
 
 void TerminalView::writeChar(int row, int col, char ch, uint8_t fg, uint8_t bg) {
-    if (row >= 0 && row < ROWS && col >= 0 && col < COLS) {
-        m_cells[row][col].character = ch;
-        m_cells[row][col].foreground = fg;
-        m_cells[row][col].background = bg;
-        invalidate();
+    if (row >= 0 && row < m_rows && col >= 0 && col < m_cols) {
+        screenRow(row)[col] = makeCell((uint8_t)ch, (uint8_t)(((bg & 0x0F) << 4) | (fg & 0x0F)));
+        markRowDirty(row);
     }
 }
 
 void TerminalView::scrollUp(int lines) {
     if (lines <= 0) return;
+    lines = std::min(lines, m_rows);
 
-    for (int row = 0; row < ROWS - lines; row++) {
-        for (int col = 0; col < COLS; col++) {
-            m_cells[row][col] = m_cells[row + lines][col];
-        }
+    // The top row becomes scrollback just by moving the ring head; only the
+    // recycled row that appears at the bottom is touched
+    for (int i = 0; i < lines; i++) {
+        m_top = (m_top + 1) % m_lineCapacity;
+        TerminalCell* bottom = screenRow(m_rows - 1);
+        std::fill(bottom, bottom + m_cols, BLANK_CELL);
+    }
+    m_history = std::min(m_history + lines, m_lineCapacity - m_rows);
+
+    // Keep a scrolled-back view on the same text while output continues
+    if (m_viewOffset > 0) {
+        m_viewOffset = std::min(m_viewOffset + lines, m_history);
     }
+    markRowsDirty(0, m_rows - 1);
+}
 
-    for (int row = ROWS - lines; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            m_cells[row][col] = TerminalCell();
+void TerminalView::setScrollbackLines(int lines) {
+    lines = std::max(0, std::min(lines, MAX_SCROLLBACK));
+    if (lines == m_scrollbackLines && !m_lines.empty()) return;
+    resizeLines(m_rows, m_cols, lines);
+}
+
+void TerminalView::setGeometry(int rows, int cols) {
+    rows = std::max(MIN_ROWS, std::min(rows, MAX_ROWS));
+    cols = std::max(MIN_COLS, std::min(cols, MAX_COLS));
+    if (rows == m_rows && cols == m_cols) return;
+    resizeLines(rows, cols, m_scrollbackLines);
+    repaint();
+}
+
+void TerminalView::resizeLines(int rows, int cols, int scrollback) {
+    // Keep the screen, drop the history. A shorter screen keeps the rows
+    // ending at the cursor so the prompt stays in view.
+    int shift = std::max(0, m_cursorRow - (rows - 1));
+    std::vector<TerminalCell> screen((size_t)rows * cols, BLANK_CELL);
+    if (!m_lines.empty()) {
+        int keepRows = std::min(rows, m_rows - shift);
+        int keepCols = std::min(cols, m_cols);
+        for (int row = 0; row < keepRows; row++) {
+            const TerminalCell* src = screenRow(row + shift);
+            std::copy(src, src + keepCols, screen.begin() + (size_t)row * cols);
         }
     }
+
+    m_rows = rows;
+    m_cols = cols;
+    m_scrollbackLines = scrollback;
+    m_lineCapacity = rows + scrollback;
+    m_lines.assign((size_t)m_lineCapacity * cols, BLANK_CELL);
+    std::copy(screen.begin(), screen.end(), m_lines.begin());
+    m_top = 0;
+    m_history = 0;
+    m_viewOffset = 0;
+
+    m_cursorRow = std::min(m_cursorRow - shift, rows - 1);
+    m_cursorCol = std::min(m_cursorCol, cols - 1);
+    m_savedCursorRow = std::min(m_savedCursorRow, rows - 1);
+    m_savedCursorCol = std::min(m_savedCursorCol, cols - 1);
+
+    m_rowDirty.assign(rows, 1);
+    m_renderer.resize(rows, cols);
+    invalidate();
+}
+
+TerminalCell* TerminalView::screenRow(int row) {
+    return &m_lines[(size_t)((m_top + row) % m_lineCapacity) * m_cols];
+}
+
+const TerminalCell* TerminalView::viewRow(int row) const {
+    int index = (m_top + row - m_viewOffset + m_lineCapacity) % m_lineCapacity;
+    return &m_lines[(size_t)index * m_cols];
+}
+
+void TerminalView::scrollView(int lines) {
+    int offset = std::max(0, std::min(m_viewOffset + lines, m_history));
+    if (offset == m_viewOffset) return;
+    m_viewOffset = offset;
     invalidate();
+    repaint();
 }
 
 void TerminalView::setAttr(uint8_t attr) {
@@ -165,7 +299,12 @@ void TerminalView::setAttr(uint8_t attr) {
 }
 
 void TerminalView::outputChar(uint8_t ch) {
-    processChar(ch);
+    m_parser.feed(ch);
+}
+
+void TerminalView::output(const uint8_t* data, size_t count) {
+    m_parser.feed(data, count);
+    m_outputSinceTick += count;
 }
 
 void TerminalView::setFontSize(int size) {
@@ -173,6 +312,7 @@ void TerminalView::setFontSize(int size) {
         m_fontSize = size;
         createFont();
         invalidate();
+        repaint();
 
         // Notify parent of size change
         if (m_parent) {
@@ -182,17 +322,70 @@ void TerminalView::setFontSize(int size) {
 }
 
 void TerminalView::invalidate() {
-    if (m_hwnd) {
-        InvalidateRect(m_hwnd, nullptr, FALSE);
+    for (int row = 0; row < m_rows; row++) {
+        m_rowDirty[row] = true;
+    }
+    m_fullRedraw = true;
+    m_damaged = true;
+}
+
+void TerminalView::markRowDirty(int row) {
+    if (row >= 0 && row < m_rows) {
+        m_rowDirty[row] = true;
+        m_damaged = true;
+    }
+}
+
+void TerminalView::markRowsDirty(int first, int last) {
+    for (int row = std::max(first, 0); row <= std::min(last, m_rows - 1); row++) {
+        m_rowDirty[row] = true;
+        m_damaged = true;
     }
 }
 
 void TerminalView::repaint() {
     if (!m_hwnd) return;
 
-    // Force repaint through WM_PAINT
-    RedrawWindow(m_hwnd, nullptr, nullptr,
-                 RDW_INVALIDATE | RDW_UPDATENOW | RDW_NOERASE);
+    // A moved cursor damages the row it was drawn on and the row it is on now
+    if (m_cursorRow != m_paintedCursorRow || m_cursorCol != m_paintedCursorCol) {
+        markRowDirty(m_paintedCursorRow);
+        markRowDirty(m_cursorRow);
+    }
+
+    // Nothing changed since the last paint: no WM_PAINT at all
+    if (!m_damaged) return;
+    m_damaged = false;
+
+    if (m_fullRedraw) {
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    } else {
+        // One rect per run of adjacent dirty rows; paint() redraws exactly
+        // the dirty rows, the rects only bound what gets blitted
+        int row = 0;
+        while (row < m_rows) {
+            if (!m_rowDirty[row]) {
+                row++;
+                continue;
+            }
+            int first = row;
+            while (row < m_rows && m_rowDirty[row]) row++;
+            RECT damage = { 0, first * m_charHeight, m_cols * m_charWidth, row * m_charHeight };
+            InvalidateRect(m_hwnd, &damage, FALSE);
+        }
+    }
+    UpdateWindow(m_hwnd);
+}
+
+void TerminalView::tick() {
+    // In a flood the cell model keeps up at parser speed; only complete
+    // frames are shown, and the screen catches up once output goes quiet
+    bool flood = m_outputSinceTick >= (size_t)m_rows * m_cols;
+    m_outputSinceTick = 0;
+
+    auto now = std::chrono::steady_clock::now();
+    if (flood && now - m_lastPresent < m_frameInterval) return;
+    m_lastPresent = now;
+    repaint();
 }
 
 LRESULT CALLBACK TerminalView::WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -220,7 +413,7 @@ LRESULT TerminalView::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
     case WM_PAINT: {
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(m_hwnd, &ps);
-        paint(hdc);
+        paint(hdc, ps.rcPaint);
         EndPaint(m_hwnd, &ps);
         return 0;
     }
@@ -235,24 +428,22 @@ LRESULT TerminalView::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
     case WM_SETFOCUS:
         m_cursorVisible = true;
-        invalidate();
+        markRowDirty(m_cursorRow);
+        repaint();
         return 0;
 
     case WM_KILLFOCUS:
         m_cursorVisible = false;
-        invalidate();
+        markRowDirty(m_cursorRow);
+        repaint();
         return 0;
 
     case WM_TIMER:
         if (wParam == 1) {
+            // Blink only damages the cursor row
             m_cursorVisible = !m_cursorVisible;
-            // Only redraw cursor area
-            RECT cursorRect;
-            cursorRect.left = m_cursorCol * m_charWidth;
-            cursorRect.top = m_cursorRow * m_charHeight;
-            cursorRect.right = cursorRect.left + m_charWidth;
-            cursorRect.bottom = cursorRect.top + m_charHeight;
-            InvalidateRect(m_hwnd, &cursorRect, FALSE);
+            markRowDirty(m_cursorRow);
+            repaint();
         }
         return 0;
 
@@ -260,7 +451,17 @@ LRESULT TerminalView::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         return 1;  // We handle background in WM_PAINT
 
     case WM_MOUSEWHEEL: {
-        // Could implement scrollback buffer here
+        // Scroll back through history; accumulate for high-resolution wheels
+        UINT linesPerNotch = 3;
+        SystemParametersInfoW(SPI_GETWHEELSCROLLLINES, 0, &linesPerNotch, 0);
+        int lines = (linesPerNotch == WHEEL_PAGESCROLL) ? m_rows - 1 : (int)linesPerNotch;
+
+        m_wheelDelta += GET_WHEEL_DELTA_WPARAM(wParam);
+        int notches = m_wheelDelta / WHEEL_DELTA;
+        m_wheelDelta %= WHEEL_DELTA;
+        if (notches) {
+            scrollView(notches * lines);
+        }
         return 0;
     }
     }
@@ -268,82 +469,95 @@ LRESULT TerminalView::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
     return DefWindowProcW(m_hwnd, msg, wParam, lParam);
 }
 
-void TerminalView::paint(HDC hdc) {
-    // Get client rect with caching
-    RECT clientRect;
-    GetClientRect(m_hwnd, &clientRect);
-
-    // Cache valid client rect dimensions (GetClientRect sometimes returns 0 outside WM_PAINT)
-    static int cachedWidth = 0, cachedHeight = 0;
-    if (clientRect.right > 0 && clientRect.bottom > 0) {
-        cachedWidth = clientRect.right;
-        cachedHeight = clientRect.bottom;
-    } else if (cachedWidth > 0 && cachedHeight > 0) {
-        clientRect.right = cachedWidth;
-        clientRect.bottom = cachedHeight;
-    }
-
-    // Don't paint if dimensions are invalid
-    if (clientRect.right <= 0 || clientRect.bottom <= 0) {
-        return;
-    }
-
-    // Double buffering
-    HDC memDC = CreateCompatibleDC(hdc);
-    HBITMAP memBitmap = CreateCompatibleBitmap(hdc, clientRect.right, clientRect.bottom);
-    HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, memBitmap);
-
-    // Fill background
-    HBRUSH bgBrush = CreateSolidBrush(RGB(0, 0, 0));
-    FillRect(memDC, &clientRect, bgBrush);
-    DeleteObject(bgBrush);
+void TerminalView::paint(HDC hdc, const RECT& updateRect) {
+    if (m_renderer.cellWidth() == 0) return;
 
-    // Select font
-    HFONT oldFont = (HFONT)SelectObject(memDC, m_font);
-    SetBkMode(memDC, OPAQUE);
-
-    // Draw characters
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            const TerminalCell& cell = m_cells[row][col];
-
-            int x = col * m_charWidth;
-            int y = row * m_charHeight;
-
-            // Set colors
-            SetTextColor(memDC, cgaToRGB(cell.foreground));
-            SetBkColor(memDC, cgaToRGB(cell.background));
+    // A new font or grid size leaves the framebuffer without content
+    if (m_fullRedraw) {
+        for (int row = 0; row < m_rows; row++) {
+            m_rowDirty[row] = true;
+        }
+        m_fullRedraw = false;
+    }
+
+    // Compose only damaged rows; the rest of the framebuffer is still
+    // current. A row counts as painted only if the update region covers all
+    // of it: when Windows sends its own partial WM_PAINT, dirty rows it
+    // misses (or only clips) stay dirty for the next repaint().
+    bool fullWidth = updateRect.left <= 0 && updateRect.right >= m_cols * m_charWidth;
+    bool showCursor = m_cursorVisible && GetFocus() == m_hwnd;
+    for (int row = 0; row < m_rows; row++) {
+        if (!m_rowDirty[row]) continue;
+        int rowTop = row * m_charHeight;
+        int rowBottom = rowTop + m_charHeight;
+        if (rowBottom <= updateRect.top || rowTop >= updateRect.bottom) {
+            m_damaged = true;
+            continue;
+        }
+        if (fullWidth && rowTop >= updateRect.top && rowBottom <= updateRect.bottom) {
+            m_rowDirty[row] = false;
+        } else {
+            m_damaged = true;
+        }
+        m_renderer.renderRow(row, viewRow(row));
 
-            // Draw character
-            char ch = cell.character;
-            if (ch < 32) ch = ' ';
-            TextOutA(memDC, x, y, &ch, 1);
+        if (showCursor && m_viewOffset == 0 && row == m_cursorRow) {
+            m_renderer.fillRect(m_cursorCol * m_charWidth, (m_cursorRow + 1) * m_charHeight - 2,
+                                 m_charWidth, 2, TerminalRenderer::cgaColor(15));
         }
     }
-
-    // Draw cursor
-    if (m_cursorVisible && GetFocus() == m_hwnd) {
-        int x = m_cursorCol * m_charWidth;
-        int y = m_cursorRow * m_charHeight;
-
-        RECT cursorRect = { x, y + m_charHeight - 2, x + m_charWidth, y + m_charHeight };
-        HBRUSH cursorBrush = CreateSolidBrush(RGB(255, 255, 255));
-        FillRect(memDC, &cursorRect, cursorBrush);
-        DeleteObject(cursorBrush);
+    m_paintedCursorRow = m_cursorRow;
+    m_paintedCursorCol = m_cursorCol;
+
+    // Present the update region with a single blit from the framebuffer
+    int fbWidth = m_renderer.width();
+    int fbHeight = m_renderer.height();
+    int left = std::max<int>(updateRect.left, 0);
+    int top = std::max<int>(updateRect.top, 0);
+    int right = std::min<int>(updateRect.right, fbWidth);
+    int bottom = std::min<int>(updateRect.bottom, fbHeight);
+    if (right > left && bottom > top) {
+        // Describe just the scanlines being drawn as their own top-down DIB,
+        // so the source origin is unambiguous
+        int lines = bottom - top;
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = fbWidth;
+        bmi.bmiHeader.biHeight = -lines;
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        SetDIBitsToDevice(hdc, left, top, right - left, lines,
+                          left, 0, 0, lines,
+                          m_renderer.pixels() + (size_t)top * fbWidth, &bmi, DIB_RGB_COLORS);
+    }
+
+    // The margin outside the cell grid
+    HBRUSH bgBrush = (HBRUSH)GetStockObject(BLACK_BRUSH);
+    if (updateRect.right > fbWidth) {
+        RECT margin = { std::max<int>(updateRect.left, fbWidth), updateRect.top, updateRect.right, updateRect.bottom };
+        FillRect(hdc, &margin, bgBrush);
+    }
+    if (updateRect.bottom > fbHeight) {
+        RECT margin = { updateRect.left, std::max<int>(updateRect.top, fbHeight),
+                        std::min<int>(updateRect.right, fbWidth), updateRect.bottom };
+        FillRect(hdc, &margin, bgBrush);
     }
-
-    SelectObject(memDC, oldFont);
-
-    // Copy to screen
-    BitBlt(hdc, 0, 0, clientRect.right, clientRect.bottom, memDC, 0, 0, SRCCOPY);
-
-    // Cleanup
-    SelectObject(memDC, oldBitmap);
-    DeleteObject(memBitmap);
-    DeleteDC(memDC);
 }
 
 void TerminalView::handleKeyDown(WPARAM wParam) {
+    // Shift+PgUp/PgDn page through scrollback without reaching the guest
+    if (GetKeyState(VK_SHIFT) < 0 && (wParam == VK_PRIOR || wParam == VK_NEXT)) {
+        scrollView(wParam == VK_PRIOR ? m_rows - 1 : -(m_rows - 1));
+        return;
+    }
+
+    // Any other key returns to the live screen
+    if (m_viewOffset > 0 && wParam != VK_SHIFT && wParam != VK_CONTROL && wParam != VK_MENU) {
+        scrollView(-m_viewOffset);
+    }
+
     // Handle special keys
     char ch = 0;
 
@@ -371,23 +585,38 @@ void TerminalView::handleChar(WPARAM wParam) {
     }
 }
 
-void TerminalView::processChar(uint8_t ch) {
-    switch (m_escapeState) {
-    case EscapeState::Normal:
-        processNormalChar(ch);
-        break;
-    case EscapeState::Escape:
-        processEscapeChar(ch);
-        break;
-    case EscapeState::CSI:
-    case EscapeState::CSIParam:
-        processCSIChar(ch);
-        break;
+void TerminalView::lineFeed() {
+    m_cursorRow++;
+    if (m_cursorRow >= m_rows) {
+        scrollUp(1);
+        m_cursorRow = m_rows - 1;
     }
 }
 
-void TerminalView::processNormalChar(uint8_t ch) {
-    switch (ch) {
+void TerminalView::print(const char* text, size_t count) {
+    const TerminalCell attr = makeCell(0, m_currentAttr & 0x7F);
+
+    // Fill up to the end of the line per step; one dirty mark per row
+    while (count > 0) {
+        TerminalCell* cells = screenRow(m_cursorRow) + m_cursorCol;
+        size_t span = std::min(count, (size_t)(m_cols - m_cursorCol));
+        for (size_t i = 0; i < span; i++) {
+            cells[i] = attr | (uint8_t)text[i];
+        }
+        markRowDirty(m_cursorRow);
+        text += span;
+        count -= span;
+
+        m_cursorCol += (int)span;
+        if (m_cursorCol >= m_cols) {
+            m_cursorCol = 0;
+            lineFeed();
+        }
+    }
+}
+
+void TerminalView::execute(uint8_t control) {
+    switch (control) {
     case 0x07:  // Bell
         MessageBeep(MB_OK);
         break;
@@ -396,163 +625,80 @@ void TerminalView::processNormalChar(uint8_t ch) {
         if (m_cursorCol > 0) {
             m_cursorCol--;
         }
-        invalidate();
         break;
 
     case 0x09:  // Tab
-        m_cursorCol = std::min((m_cursorCol + 8) & ~7, COLS - 1);
-        invalidate();
+        m_cursorCol = std::min((m_cursorCol + 8) & ~7, m_cols - 1);
         break;
 
     case 0x0A:  // Line feed
-        m_cursorRow++;
-        if (m_cursorRow >= ROWS) {
-            scrollUp(1);
-            m_cursorRow = ROWS - 1;
-        }
-        invalidate();
+        lineFeed();
         break;
 
     case 0x0D:  // Carriage return
         m_cursorCol = 0;
-        invalidate();
-        break;
-
-    case 0x1B:  // ESC
-        m_escapeState = EscapeState::Escape;
-        m_escapeParams.clear();
-        m_escapeCurrentParam.clear();
-        break;
-
-    default:
-        // Printable character
-        if (ch >= 0x20 && ch <= 0x7E) {
-            m_cells[m_cursorRow][m_cursorCol].character = (char)ch;
-            m_cells[m_cursorRow][m_cursorCol].foreground = m_currentAttr & 0x0F;
-            m_cells[m_cursorRow][m_cursorCol].background = (m_currentAttr >> 4) & 0x07;
-
-            m_cursorCol++;
-            if (m_cursorCol >= COLS) {
-                m_cursorCol = 0;
-                m_cursorRow++;
-                if (m_cursorRow >= ROWS) {
-                    scrollUp(1);
-                    m_cursorRow = ROWS - 1;
-                }
-            }
-            invalidate();
-        }
         break;
     }
 }
 
-void TerminalView::processEscapeChar(uint8_t ch) {
-    switch (ch) {
-    case '[':  // CSI
-        m_escapeState = EscapeState::CSI;
-        break;
+void TerminalView::escDispatch(uint8_t finalChar, uint8_t intermediate) {
+    if (intermediate) return;  // Character set selection etc. not supported
 
+    switch (finalChar) {
     case '7':  // Save cursor
         m_savedCursorRow = m_cursorRow;
         m_savedCursorCol = m_cursorCol;
-        m_escapeState = EscapeState::Normal;
         break;
 
     case '8':  // Restore cursor
         m_cursorRow = m_savedCursorRow;
         m_cursorCol = m_savedCursorCol;
-        m_escapeState = EscapeState::Normal;
-        invalidate();
         break;
 
     case 'D':  // Index (move down)
-        m_cursorRow++;
-        if (m_cursorRow >= ROWS) {
-            scrollUp(1);
-            m_cursorRow = ROWS - 1;
-        }
-        m_escapeState = EscapeState::Normal;
-        invalidate();
+        lineFeed();
         break;
 
     case 'M':  // Reverse index (move up)
         if (m_cursorRow > 0) {
             m_cursorRow--;
         }
-        m_escapeState = EscapeState::Normal;
-        invalidate();
         break;
 
     case 'E':  // Next line
         m_cursorCol = 0;
-        m_cursorRow++;
-        if (m_cursorRow >= ROWS) {
-            scrollUp(1);
-            m_cursorRow = ROWS - 1;
-        }
-        m_escapeState = EscapeState::Normal;
-        invalidate();
-        break;
-
-    default:
-        m_escapeState = EscapeState::Normal;
+        lineFeed();
         break;
     }
 }
 
-void TerminalView::processCSIChar(uint8_t ch) {
-    if (ch >= '0' && ch <= '9') {
-        m_escapeCurrentParam += (char)ch;
-        m_escapeState = EscapeState::CSIParam;
-        return;
-    }
-
-    if (ch == ';') {
-        m_escapeParams.push_back(m_escapeCurrentParam.empty() ? 0 : std::stoi(m_escapeCurrentParam));
-        m_escapeCurrentParam.clear();
-        m_escapeState = EscapeState::CSIParam;
-        return;
-    }
-
-    // Final character
-    if (!m_escapeCurrentParam.empty()) {
-        m_escapeParams.push_back(std::stoi(m_escapeCurrentParam));
-    }
-
-    executeCSI(ch);
-    m_escapeState = EscapeState::Normal;
-}
+void TerminalView::csiDispatch(uint8_t finalChar, const Vt100Params& params) {
+    // Private (DEC mode) and intermediate sequences are not supported
+    if (params.prefix || params.intermediate) return;
 
-void TerminalView::executeCSI(uint8_t finalChar) {
-    int p1 = m_escapeParams.size() > 0 ? m_escapeParams[0] : 0;
-    int p2 = m_escapeParams.size() > 1 ? m_escapeParams[1] : 0;
+    int p1 = params.count > 0 ? params.values[0] : 0;
 
     switch (finalChar) {
     case 'A':  // Cursor up
-        m_cursorRow = std::max(m_cursorRow - std::max(p1, 1), 0);
-        invalidate();
+        m_cursorRow = std::max(m_cursorRow - params.get(0, 1), 0);
         break;
 
     case 'B':  // Cursor down
-        m_cursorRow = std::min(m_cursorRow + std::max(p1, 1), ROWS - 1);
-        invalidate();
+        m_cursorRow = std::min(m_cursorRow + params.get(0, 1), m_rows - 1);
         break;
 
     case 'C':  // Cursor forward
-        m_cursorCol = std::min(m_cursorCol + std::max(p1, 1), COLS - 1);
-        invalidate();
+        m_cursorCol = std::min(m_cursorCol + params.get(0, 1), m_cols - 1);
         break;
 
     case 'D':  // Cursor back
-        m_cursorCol = std::max(m_cursorCol - std::max(p1, 1), 0);
-        invalidate();
+        m_cursorCol = std::max(m_cursorCol - params.get(0, 1), 0);
         break;
 
     case 'H':
     case 'f':  // Cursor position
-        m_cursorRow = std::max(0, std::min(std::max(p1, 1) - 1, ROWS - 1));
-        m_cursorCol = std::max(0, std::min(std::max(p2, 1) - 1, COLS - 1));
-        invalidate();
+        m_cursorRow = std::min(params.get(0, 1) - 1, m_rows - 1);
+        m_cursorCol = std::min(params.get(1, 1) - 1, m_cols - 1);
         break;
 
     case 'J':  // Erase in display
@@ -566,30 +712,30 @@ void TerminalView::executeCSI(uint8_t finalChar) {
     case 'K':  // Erase in line
         switch (p1) {
         case 0:  // Clear to end of line
-            for (int col = m_cursorCol; col < COLS; col++) {
-                m_cells[m_cursorRow][col] = TerminalCell();
+            for (int col = m_cursorCol; col < m_cols; col++) {
+                screenRow(m_cursorRow)[col] = BLANK_CELL;
             }
             break;
         case 1:  // Clear to beginning
             for (int col = 0; col <= m_cursorCol; col++) {
-                m_cells[m_cursorRow][col] = TerminalCell();
+                screenRow(m_cursorRow)[col] = BLANK_CELL;
             }
             break;
         case 2:  // Clear entire line
-            for (int col = 0; col < COLS; col++) {
-                m_cells[m_cursorRow][col] = TerminalCell();
+            for (int col = 0; col < m_cols; col++) {
+                screenRow(m_cursorRow)[col] = BLANK_CELL;
             }
             break;
         }
-        invalidate();
+        markRowDirty(m_cursorRow);
         break;
 
     case 'm':  // SGR (Select Graphic Rendition)
-        if (m_escapeParams.empty()) {
+        if (params.count == 0) {
             m_currentAttr = 0x07;
         } else {
-            for (int param : m_escapeParams) {
-                applySGR(param);
+            for (int i = 0; i < params.count; i++) {
+                applySGR(params.values[i]);
             }
         }
         break;
@@ -602,7 +748,6 @@ void TerminalView::executeCSI(uint8_t finalChar) {
     case 'u':  // Restore cursor
         m_cursorRow = m_savedCursorRow;
         m_cursorCol = m_savedCursorCol;
-        invalidate();
         break;
     }
 }
@@ -636,49 +781,25 @@ void TerminalView::applySGR(int param) {
 }
 
 void TerminalView::clearFromCursor() {
-    for (int col = m_cursorCol; col < COLS; col++) {
-        m_cells[m_cursorRow][col] = TerminalCell();
+    for (int col = m_cursorCol; col < m_cols; col++) {
+        screenRow(m_cursorRow)[col] = BLANK_CELL;
     }
-    for (int row = m_cursorRow + 1; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            m_cells[row][col] = TerminalCell();
+    for (int row = m_cursorRow + 1; row < m_rows; row++) {
+        for (int col = 0; col < m_cols; col++) {
+            screenRow(row)[col] = BLANK_CELL;
         }
     }
-    invalidate();
+    markRowsDirty(m_cursorRow, m_rows - 1);
 }
 
 void TerminalView::clearToCursor() {
     for (int row = 0; row < m_cursorRow; row++) {
-        for (int col = 0; col < COLS; col++) {
-            m_cells[row][col] = TerminalCell();
+        for (int col = 0; col < m_cols; col++) {
+            screenRow(row)[col] = BLANK_CELL;
         }
     }
     for (int col = 0; col <= m_cursorCol; col++) {
-        m_cells[m_cursorRow][col] = TerminalCell();
+        screenRow(m_cursorRow)[col] = BLANK_CELL;
     }
-    invalidate();
-}
-
-COLORREF TerminalView::cgaToRGB(uint8_t cgaColor) {
-    // CGA color palette
-    static const COLORREF palette[16] = {
-        RGB(0, 0, 0),        // 0: Black
-        RGB(0, 0, 170),      // 1: Blue
-        RGB(0, 170, 0),      // 2: Green
-        RGB(0, 170, 170),    // 3: Cyan
-        RGB(170, 0, 0),      // 4: Red
-        RGB(170, 0, 170),    // 5: Magenta
-        RGB(170, 85, 0),     // 6: Brown
-        RGB(170, 170, 170),  // 7: Light gray
-        RGB(85, 85, 85),     // 8: Dark gray
-        RGB(85, 85, 255),    // 9: Light blue
-        RGB(85, 255, 85),    // 10: Light green
-        RGB(85, 255, 255),   // 11: Light cyan
-        RGB(255, 85, 85),    // 12: Light red
-        RGB(255, 85, 255),   // 13: Light magenta
-        RGB(255, 255, 85),   // 14: Yellow
-        RGB(255, 255, 255),  // 15: White
-    };
-
-    return palette[cgaColor & 0x0F];
+    markRowsDirty(0, m_cursorRow);
 }
@@ -2,29 +2,32 @@
  * TerminalView.h - Terminal Display Component
  *
  * A VT100-compatible terminal display for the emulator.
- * 25 rows x 80 columns of character cells.
+ * A grid of character cells, 80x25 by default and up to 132x60.
  */
 
 #pragma once
 
 #include <windows.h>
+#include <chrono>
 #include <string>
 #include <functional>
-
-// Terminal cell structure
-struct TerminalCell {
-    char character = ' ';
-    uint8_t foreground = 7;  // White
-    uint8_t background = 0;  // Black
-};
+#include <vector>
+#include "TerminalRenderer.h"
+#include "Vt100Parser.h"
 
 // Input callback type
 using KeyInputCallback = std::function<void(char ch)>;
 
-class TerminalView {
+class TerminalView : private Vt100Handler {
 public:
-    static constexpr int ROWS = 25;
-    static constexpr int COLS = 80;
+    static constexpr int DEFAULT_ROWS = 25;
+    static constexpr int DEFAULT_COLS = 80;
+    static constexpr int MIN_ROWS = 10;
+    static constexpr int MIN_COLS = 40;
+    static constexpr int MAX_ROWS = 60;
+    static constexpr int MAX_COLS = 132;
+    static constexpr int DEFAULT_SCROLLBACK = 10000;
+    static constexpr int MAX_SCROLLBACK = 100000;
 
     TerminalView();
     ~TerminalView();
@@ -41,8 +44,20 @@ public:
     void scrollUp(int lines);
     void setAttr(uint8_t attr);
 
-    // Output a character with VT100 escape sequence processing
+    // Output characters with VT100 escape sequence processing
     void outputChar(uint8_t ch);
+    void output(const uint8_t* data, size_t count);
+
+    // Lines of history kept above the screen (0 disables); changing it drops
+    // the current history
+    void setScrollbackLines(int lines);
+    int getScrollbackLines() const { return m_scrollbackLines; }
+
+    // Screen size in cells; changing it keeps what still fits of the screen
+    // (with the cursor's row) and drops the history
+    void setGeometry(int rows, int cols);
+    int getRows() const { return m_rows; }
+    int getCols() const { return m_cols; }
 
     // Font
     void setFontSize(int size);
@@ -55,39 +70,72 @@ public:
     int getCharWidth() const { return m_charWidth; }
     int getCharHeight() const { return m_charHeight; }
 
-    // Force redraw
+    // Mark the whole view for redraw at the next repaint()
     void invalidate();
 
-    // Force immediate repaint (bypassing WM_PAINT)
+    // Paint damaged rows now; does nothing when nothing changed
     void repaint();
 
+    // Once per UI tick, after output was fed: a trickle of output paints at
+    // once, a flood is presented at the display refresh rate only
+    void tick();
+
 private:
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
     LRESULT handleMessage(UINT msg, WPARAM wParam, LPARAM lParam);
 
     void createFont();
-    void paint(HDC hdc);
+    void paint(HDC hdc, const RECT& updateRect);
+    TerminalCell* screenRow(int row);           // Live screen row
+    const TerminalCell* viewRow(int row) const; // Row as displayed (live or scrolled back)
+    void scrollView(int lines);                 // Positive = back into history
+    void resizeLines(int rows, int cols, int scrollback);
+    void markRowDirty(int row);
+    void markRowsDirty(int first, int last);
     void handleKeyDown(WPARAM wParam);
     void handleChar(WPARAM wParam);
 
-    // VT100 escape sequence processing
-    void processChar(uint8_t ch);
-    void processNormalChar(uint8_t ch);
-    void processEscapeChar(uint8_t ch);
-    void processCSIChar(uint8_t ch);
-    void executeCSI(uint8_t finalChar);
+    // Vt100Handler: parsed guest output
+    void print(const char* text, size_t count) override;
+    void execute(uint8_t control) override;
+    void escDispatch(uint8_t finalChar, uint8_t intermediate) override;
+    void csiDispatch(uint8_t finalChar, const Vt100Params& params) override;
+
+    void lineFeed();
     void applySGR(int param);
     void clearFromCursor();
     void clearToCursor();
 
-    // CGA color to RGB conversion
-    static COLORREF cgaToRGB(uint8_t cgaColor);
-
     HWND m_hwnd = nullptr;
     HWND m_parent = nullptr;
     HFONT m_font = nullptr;
 
-    TerminalCell m_cells[ROWS][COLS];
+    // Framebuffer composed from the glyph atlas, kept across paints
+    TerminalRenderer m_renderer;
+
+    // Damage tracking: rows changed since they were last drawn
+    std::vector<uint8_t> m_rowDirty;  // One flag per screen row
+    bool m_fullRedraw = true;      // Framebuffer needs every row
+    bool m_damaged = false;        // Dirty rows not yet invalidated
+    int m_paintedCursorRow = 0;    // Where the cursor was last drawn
+    int m_paintedCursorCol = 0;
+
+    // Burst mode: output fed since the last tick, and frame pacing
+    size_t m_outputSinceTick = 0;       // A screenful per tick is a flood
+    std::chrono::steady_clock::time_point m_lastPresent;
+    std::chrono::steady_clock::duration m_frameInterval = std::chrono::milliseconds(16);
+
+    // Screen and scrollback share one ring of rows; scrolling the screen
+    // only advances m_top
+    int m_rows = DEFAULT_ROWS;
+    int m_cols = DEFAULT_COLS;
+    std::vector<TerminalCell> m_lines;  // m_lineCapacity rows of m_cols cells
+    int m_lineCapacity = 0;
+    int m_top = 0;                      // Ring index of screen row 0
+    int m_history = 0;                  // Valid scrollback rows above the screen
+    int m_scrollbackLines = 0;
+    int m_viewOffset = 0;               // Rows scrolled back (0 = live screen)
+    int m_wheelDelta = 0;               // Partial wheel notches
     int m_cursorRow = 0;
     int m_cursorCol = 0;
     int m_savedCursorRow = 0;
@@ -99,16 +147,7 @@ private:
     int m_charWidth = 8;
     int m_charHeight = 16;
 
-    // Escape sequence state
-    enum class EscapeState {
-        Normal,
-        Escape,
-        CSI,
-        CSIParam
-    };
-    EscapeState m_escapeState = EscapeState::Normal;
-    std::vector<int> m_escapeParams;
-    std::string m_escapeCurrentParam;
+    Vt100Parser m_parser;
 
     KeyInputCallback m_keyCallback;
 
@@ -0,0 +1,172 @@
+/*
+ * Vt100Parser.cpp - Table-Driven VT100/ANSI Escape Sequence Parser Implementation
+ *
+ * Built without the precompiled header so it stays free of Windows headers.
+ */
+
+#include "Vt100Parser.h"
+
+namespace {
+
+// Each entry packs the action (high nibble) and the next state (low nibble)
+struct TransitionTable {
+    uint8_t entries[Vt100Parser::STATE_COUNT][256];
+
+    void set(int state, int first, int last, Vt100Parser::Action action, int next) {
+        for (int ch = first; ch <= last; ch++) {
+            entries[state][ch] = (uint8_t)((action << 4) | next);
+        }
+    }
+
+    TransitionTable() {
+        using P = Vt100Parser;
+
+        for (int state = 0; state < P::STATE_COUNT; state++) {
+            // Unlisted bytes (DEL, 8-bit) are ignored in place
+            set(state, 0x00, 0xFF, P::ACTION_NONE, state);
+
+            // C0 controls execute without disturbing a sequence in progress,
+            // except inside a string where they are part of it
+            if (state != P::STATE_STRING) {
+                set(state, 0x00, 0x17, P::ACTION_EXECUTE, state);
+                set(state, 0x19, 0x19, P::ACTION_EXECUTE, state);
+                set(state, 0x1C, 0x1F, P::ACTION_EXECUTE, state);
+            }
+
+            // "Anywhere" transitions: CAN/SUB abort, ESC restarts
+            set(state, 0x18, 0x18, P::ACTION_EXECUTE, P::STATE_GROUND);
+            set(state, 0x1A, 0x1A, P::ACTION_EXECUTE, P::STATE_GROUND);
+            set(state, 0x1B, 0x1B, P::ACTION_CLEAR, P::STATE_ESCAPE);
+        }
+
+        set(P::STATE_GROUND, 0x20, 0x7E, P::ACTION_PRINT, P::STATE_GROUND);
+
+        set(P::STATE_ESCAPE, 0x20, 0x2F, P::ACTION_COLLECT, P::STATE_ESCAPE_INTERMEDIATE);
+        set(P::STATE_ESCAPE, 0x30, 0x7E, P::ACTION_ESC_DISPATCH, P::STATE_GROUND);
+        set(P::STATE_ESCAPE, '[', '[', P::ACTION_NONE, P::STATE_CSI_ENTRY);
+        set(P::STATE_ESCAPE, ']', ']', P::ACTION_NONE, P::STATE_STRING);
+        set(P::STATE_ESCAPE, 'P', 'P', P::ACTION_NONE, P::STATE_STRING);
+        set(P::STATE_ESCAPE, 'X', 'X', P::ACTION_NONE, P::STATE_STRING);
+        set(P::STATE_ESCAPE, '^', '_', P::ACTION_NONE, P::STATE_STRING);
+
+        set(P::STATE_ESCAPE_INTERMEDIATE, 0x20, 0x2F, P::ACTION_COLLECT, P::STATE_ESCAPE_INTERMEDIATE);
+        set(P::STATE_ESCAPE_INTERMEDIATE, 0x30, 0x7E, P::ACTION_ESC_DISPATCH, P::STATE_GROUND);
+
+        set(P::STATE_CSI_ENTRY, 0x20, 0x2F, P::ACTION_COLLECT, P::STATE_CSI_INTERMEDIATE);
+        set(P::STATE_CSI_ENTRY, 0x30, 0x39, P::ACTION_PARAM, P::STATE_CSI_PARAM);
+        set(P::STATE_CSI_ENTRY, 0x3A, 0x3A, P::ACTION_NONE, P::STATE_CSI_IGNORE);
+        set(P::STATE_CSI_ENTRY, 0x3B, 0x3B, P::ACTION_PARAM, P::STATE_CSI_PARAM);
+        set(P::STATE_CSI_ENTRY, 0x3C, 0x3F, P::ACTION_PREFIX, P::STATE_CSI_PARAM);
+        set(P::STATE_CSI_ENTRY, 0x40, 0x7E, P::ACTION_CSI_DISPATCH, P::STATE_GROUND);
+
+        set(P::STATE_CSI_PARAM, 0x20, 0x2F, P::ACTION_COLLECT, P::STATE_CSI_INTERMEDIATE);
+        set(P::STATE_CSI_PARAM, 0x30, 0x39, P::ACTION_PARAM, P::STATE_CSI_PARAM);
+        set(P::STATE_CSI_PARAM, 0x3A, 0x3A, P::ACTION_NONE, P::STATE_CSI_IGNORE);
+        set(P::STATE_CSI_PARAM, 0x3B, 0x3B, P::ACTION_PARAM, P::STATE_CSI_PARAM);
+        set(P::STATE_CSI_PARAM, 0x3C, 0x3F, P::ACTION_NONE, P::STATE_CSI_IGNORE);
+        set(P::STATE_CSI_PARAM, 0x40, 0x7E, P::ACTION_CSI_DISPATCH, P::STATE_GROUND);
+
+        set(P::STATE_CSI_INTERMEDIATE, 0x20, 0x2F, P::ACTION_COLLECT, P::STATE_CSI_INTERMEDIATE);
+        set(P::STATE_CSI_INTERMEDIATE, 0x30, 0x3F, P::ACTION_NONE, P::STATE_CSI_IGNORE);
+        set(P::STATE_CSI_INTERMEDIATE, 0x40, 0x7E, P::ACTION_CSI_DISPATCH, P::STATE_GROUND);
+
+        set(P::STATE_CSI_IGNORE, 0x40, 0x7E, P::ACTION_NONE, P::STATE_GROUND);
+
+        // BEL ends an OSC string (xterm); ESC \ (ST) ends any string via the
+        // ESC transition above
+        set(P::STATE_STRING, 0x07, 0x07, P::ACTION_NONE, P::STATE_GROUND);
+    }
+};
+
+const TransitionTable g_table;
+
+}  // namespace
+
+void Vt100Parser::reset() {
+    m_state = STATE_GROUND;
+    perform(ACTION_CLEAR, 0);
+}
+
+void Vt100Parser::feed(const uint8_t* data, size_t count) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + count;
+
+    while (p < end) {
+        // Fast path: hand over the whole run of plain text at once
+        if (m_state == STATE_GROUND) {
+            const uint8_t* run = p;
+            while (p < end && *p >= 0x20 && *p <= 0x7E) {
+                p++;
+            }
+            if (p != run) {
+                m_handler.print((const char*)run, (size_t)(p - run));
+                continue;
+            }
+        }
+
+        uint8_t ch = *p++;
+        uint8_t entry = g_table.entries[m_state][ch];
+        m_state = (State)(entry & 0x0F);
+        perform((Action)(entry >> 4), ch);
+    }
+}
+
+void Vt100Parser::perform(Action action, uint8_t ch) {
+    switch (action) {
+    case ACTION_NONE:
+        break;
+
+    case ACTION_PRINT: {
+        char c = (char)ch;
+        m_handler.print(&c, 1);
+        break;
+    }
+
+    case ACTION_EXECUTE:
+        m_handler.execute(ch);
+        break;
+
+    case ACTION_CLEAR:
+        m_params.count = 0;
+        m_params.prefix = 0;
+        m_params.intermediate = 0;
+        m_paramOverflow = false;
+        break;
+
+    case ACTION_COLLECT:
+        m_params.intermediate = ch;
+        break;
+
+    case ACTION_PREFIX:
+        m_params.prefix = ch;
+        break;
+
+    case ACTION_PARAM:
+        if (m_paramOverflow) break;
+        if (m_params.count == 0) {
+            m_params.values[0] = 0;
+            m_params.count = 1;
+        }
+        if (ch == ';') {
+            if (m_params.count == Vt100Params::MAX_PARAMS) {
+                m_paramOverflow = true;
+            } else {
+                m_params.values[m_params.count++] = 0;
+            }
+        } else {
+            // Saturate rather than wrap on absurd values
+            uint16_t& value = m_params.values[m_params.count - 1];
+            uint32_t next = value * 10u + (ch - '0');
+            value = (uint16_t)(next > 0xFFFF ? 0xFFFF : next);
+        }
+        break;
+
+    case ACTION_ESC_DISPATCH:
+        m_handler.escDispatch(ch, m_params.intermediate);
+        break;
+
+    case ACTION_CSI_DISPATCH:
+        m_handler.csiDispatch(ch, m_params);
+        break;
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Vt100Parser.h - Table-Driven VT100/ANSI Escape Sequence Parser
+ *
+ * A DEC-style parser state machine (after the VT500 series state diagram,
+ * 7-bit only). Every transition comes from one state x byte table; runs of
+ * printable text in the ground state are handed to the handler as a single
+ * span. Parameters live in fixed storage, so feeding never allocates.
+ *
+ * Portable: no Windows headers, so it can be tested and benchmarked alone.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Parameters of a CSI sequence
+struct Vt100Params {
+    static constexpr int MAX_PARAMS = 16;
+
+    uint16_t values[MAX_PARAMS];
+    int count = 0;              // Parameters present (an empty one counts as 0)
+    uint8_t prefix = 0;         // Private marker '<' '=' '>' '?', or 0
+    uint8_t intermediate = 0;   // Last 0x20-0x2F byte, or 0
+
+    // Parameter i, or def when it is missing or 0
+    int get(int i, int def) const {
+        return (i < count && values[i] != 0) ? values[i] : def;
+    }
+};
+
+// Receives parsed output; the terminal implements this
+class Vt100Handler {
+public:
+    virtual ~Vt100Handler() = default;
+
+    // Printable characters (0x20-0x7E) in the ground state
+    virtual void print(const char* text, size_t count) = 0;
+
+    // C0 control character (BEL, BS, HT, LF, CR, ...)
+    virtual void execute(uint8_t control) = 0;
+
+    // ESC final, e.g. ESC 7, ESC D
+    virtual void escDispatch(uint8_t finalChar, uint8_t intermediate) = 0;
+
+    // ESC [ params final
+    virtual void csiDispatch(uint8_t finalChar, const Vt100Params& params) = 0;
+};
+
+class Vt100Parser {
+public:
+    explicit Vt100Parser(Vt100Handler& handler) : m_handler(handler) {}
+
+    // Parse a block of output
+    void feed(const uint8_t* data, size_t count);
+    void feed(uint8_t ch) { feed(&ch, 1); }
+
+    // Drop any partial sequence
+    void reset();
+
+    enum State : uint8_t {
+        STATE_GROUND,
+        STATE_ESCAPE,
+        STATE_ESCAPE_INTERMEDIATE,
+        STATE_CSI_ENTRY,
+        STATE_CSI_PARAM,
+        STATE_CSI_INTERMEDIATE,
+        STATE_CSI_IGNORE,
+        STATE_STRING,               // OSC/DCS/SOS/PM/APC body, ignored
+        STATE_COUNT
+    };
+
+    enum Action : uint8_t {
+        ACTION_NONE,
+        ACTION_PRINT,
+        ACTION_EXECUTE,
+        ACTION_CLEAR,
+        ACTION_COLLECT,
+        ACTION_PREFIX,
+        ACTION_PARAM,
+        ACTION_ESC_DISPATCH,
+        ACTION_CSI_DISPATCH,
+    };
+
+private:
+    void perform(Action action, uint8_t ch);
+
+    Vt100Handler& m_handler;
+    State m_state = STATE_GROUND;
+    Vt100Params m_params;
+    bool m_paramOverflow = false;   // More than MAX_PARAMS; extras dropped
+};
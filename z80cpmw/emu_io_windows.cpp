@@ -7,7 +7,8 @@
 
 #include "pch.h"
 #include "emu_io.h"
-#include <queue>
+#include "SpscRing.h"
+#include <atomic>
 #include <mutex>
 #include <random>
 #include <cstdarg>
@@ -34,19 +35,18 @@ static const size_t EMU_HD1K_COMBO_SIZE = 128 * 1024 * 1024;     // 128MB
 //=============================================================================
 
 // Callback function types
-using OutputCharCallback = void(*)(uint8_t ch);
 using VideoCallback = void(*)(int cmd, int p1, int p2, uint8_t p3);
 using BeepCallback = void(*)(int durationMs);
 
-static OutputCharCallback g_outputCallback = nullptr;
 static VideoCallback g_videoCallback = nullptr;
 static BeepCallback g_beepCallback = nullptr;
 
+// Guest console output, written by the emulation side and drained in bulk by
+// the terminal. Sized well past what one batch of instructions can print.
+static SpscRing<uint8_t, 256 * 1024> g_outputRing;
+
 // Set callbacks (called from EmulatorEngine)
 extern "C" {
-    void emu_io_set_output_callback(OutputCharCallback cb) {
-        g_outputCallback = cb;
-    }
     void emu_io_set_video_callback(VideoCallback cb) {
         g_videoCallback = cb;
     }
@@ -75,54 +75,102 @@ int emu_strncasecmp(const char* s1, const char* s2, size_t n) {
 // Input Queue
 //=============================================================================
 
-static std::queue<int> g_inputQueue;
-static std::mutex g_inputMutex;
+// Keyboard input: the UI thread pushes, the guest polls has_input in tight
+// loops, so the consumer side is a plain acquire load with no lock
+static SpscRing<uint8_t, 16 * 1024> g_inputRing;
+static HANDLE g_inputEvent = nullptr;  // Signaled when input arrives (or to wake)
 static std::mt19937 g_rng(std::random_device{}());
 static bool g_debugEnabled = false;
 
 void emu_io_init() {
-    // Nothing special needed for Windows GUI
+    if (!g_inputEvent) {
+        g_inputEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    }
 }
 
 void emu_io_cleanup() {
-    // Nothing special needed
+    if (g_inputEvent) {
+        CloseHandle(g_inputEvent);
+        g_inputEvent = nullptr;
+    }
 }
 
 bool emu_console_has_input() {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
-    return !g_inputQueue.empty();
+    return !g_inputRing.empty();
 }
 
 int emu_console_read_char() {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
-    if (g_inputQueue.empty()) {
+    uint8_t ch;
+    if (!g_inputRing.pop(ch)) {
         return -1;
     }
-    int ch = g_inputQueue.front();
-    g_inputQueue.pop();
     // Convert LF to CR for CP/M
     if (ch == '\n') ch = '\r';
     return ch;
 }
 
 void emu_console_queue_char(int ch) {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
-    g_inputQueue.push(ch);
+    uint8_t byte = (uint8_t)ch;
+    g_inputRing.push(&byte, 1);
+    if (g_inputEvent) SetEvent(g_inputEvent);
+}
+
+// Queue a block of input (pastes); returns how many fit, the caller keeps
+// the rest for later
+extern "C" size_t emu_console_queue_chars(const uint8_t* data, size_t count) {
+    size_t queued = g_inputRing.push(data, count);
+    if (queued && g_inputEvent) SetEvent(g_inputEvent);
+    return queued;
+}
+
+// Sleep until input arrives, emu_console_wake() is called, or the timeout
+extern "C" bool emu_console_wait_input(int timeoutMs) {
+    if (emu_console_has_input()) return true;
+    if (g_inputEvent) WaitForSingleObject(g_inputEvent, (DWORD)timeoutMs);
+    return emu_console_has_input();
 }
 
+extern "C" void emu_console_wake() {
+    if (g_inputEvent) SetEvent(g_inputEvent);
+}
+
+// Consumer side: called from the emulator thread, or with it stopped
 void emu_console_clear_queue() {
-    std::lock_guard<std::mutex> lock(g_inputMutex);
-    while (!g_inputQueue.empty()) {
-        g_inputQueue.pop();
-    }
+    g_inputRing.clear();
 }
 
 void emu_console_write_char(uint8_t ch) {
-    if (g_outputCallback) {
-        g_outputCallback(ch & 0x7F);
+    g_outputRing.push((uint8_t)(ch & 0x7F));
+}
+
+// Bulk output from the engine (HBIOS-buffered characters)
+extern "C" void emu_console_write_block(const uint8_t* data, size_t count) {
+    uint8_t chunk[256];
+    while (count > 0) {
+        size_t n = std::min(count, sizeof(chunk));
+        for (size_t i = 0; i < n; i++) {
+            chunk[i] = data[i] & 0x7F;
+        }
+        g_outputRing.push(chunk, n);
+        data += n;
+        count -= n;
     }
 }
 
+// Consumer side: contiguous queued output, released with _consume()
+extern "C" size_t emu_console_output_peek(const uint8_t** data) {
+    return g_outputRing.readSpan(data);
+}
+
+extern "C" void emu_console_output_consume(size_t count) {
+    g_outputRing.consume(count);
+}
+
+// Producer side: room left before output would be dropped
+extern "C" size_t emu_console_output_space() {
+    return g_outputRing.CAPACITY - g_outputRing.size();
+}
+
 bool emu_console_check_escape(char escape_char) {
     (void)escape_char;
     return false; // Not used in GUI mode
@@ -321,46 +369,22 @@ size_t emu_file_size(const std::string& path) {
 //=============================================================================
 
 #include <set>
+#include "DiskStore.h"
 
+// An open disk; the store decides how bytes map onto the host file
 struct disk_file {
-    FILE* fp;
-    size_t size;
+    std::unique_ptr<DiskStore> store;
 };
 
 // Track all open disks for emu_disk_flush_all
 static std::set<disk_file*> g_openDisks;
 
 emu_disk_handle emu_disk_open(const std::string& path, const char* mode) {
-    const char* fmode;
-    if (strcmp(mode, "r") == 0) {
-        fmode = "rb";
-    } else if (strcmp(mode, "rw") == 0) {
-        fmode = "r+b";
-    } else if (strcmp(mode, "rw+") == 0) {
-        fmode = "r+b";
-        FILE* f = fopen(path.c_str(), fmode);
-        if (!f) {
-            f = fopen(path.c_str(), "w+b");
-        }
-        if (!f) return nullptr;
-
-        disk_file* disk = new disk_file;
-        disk->fp = f;
-        fseek(f, 0, SEEK_END);
-        disk->size = ftell(f);
-        g_openDisks.insert(disk);
-        return disk;
-    } else {
-        return nullptr;
-    }
-
-    FILE* f = fopen(path.c_str(), fmode);
-    if (!f) return nullptr;
+    std::unique_ptr<DiskStore> store = openDiskStore(path, mode);
+    if (!store) return nullptr;
 
     disk_file* disk = new disk_file;
-    disk->fp = f;
-    fseek(f, 0, SEEK_END);
-    disk->size = ftell(f);
+    disk->store = std::move(store);
     g_openDisks.insert(disk);
     return disk;
 }
@@ -369,7 +393,6 @@ void emu_disk_close(emu_disk_handle handle) {
     if (!handle) return;
     disk_file* disk = static_cast<disk_file*>(handle);
     g_openDisks.erase(disk);
-    if (disk->fp) fclose(disk->fp);
     delete disk;
 }
 
@@ -377,39 +400,45 @@ size_t emu_disk_read(emu_disk_handle handle, size_t offset,
                      uint8_t* buffer, size_t count) {
     if (!handle) return 0;
     disk_file* disk = static_cast<disk_file*>(handle);
-    if (!disk->fp) return 0;
-
-    fseek(disk->fp, (long)offset, SEEK_SET);
-    return fread(buffer, 1, count, disk->fp);
+    return disk->store->read(offset, buffer, count);
 }
 
 size_t emu_disk_write(emu_disk_handle handle, size_t offset,
                       const uint8_t* buffer, size_t count) {
     if (!handle) return 0;
     disk_file* disk = static_cast<disk_file*>(handle);
-    if (!disk->fp) return 0;
-
-    fseek(disk->fp, (long)offset, SEEK_SET);
-    size_t written = fwrite(buffer, 1, count, disk->fp);
-
-    size_t newEnd = offset + written;
-    if (newEnd > disk->size) {
-        disk->size = newEnd;
-    }
-
-    return written;
+    return disk->store->write(offset, buffer, count);
 }
 
 void emu_disk_flush(emu_disk_handle handle) {
     if (!handle) return;
     disk_file* disk = static_cast<disk_file*>(handle);
-    if (disk->fp) fflush(disk->fp);
+    disk->store->flush();
 }
 
 void emu_disk_flush_all() {
     for (disk_file* disk : g_openDisks) {
-        if (disk && disk->fp) {
-            fflush(disk->fp);
+        if (disk) {
+            disk->store->flush();
+        }
+    }
+}
+
+// Close the open write transaction on every journaled disk (group commit)
+extern "C" void emu_disk_commit_all() {
+    for (disk_file* disk : g_openDisks) {
+        if (disk) {
+            disk->store->commit();
+        }
+    }
+}
+
+// Make every open image file complete and durable (journals checkpointed),
+// e.g. before it is copied
+extern "C" void emu_disk_sync_all() {
+    for (disk_file* disk : g_openDisks) {
+        if (disk) {
+            disk->store->sync();
         }
     }
 }
@@ -417,7 +446,7 @@ void emu_disk_flush_all() {
 size_t emu_disk_size(emu_disk_handle handle) {
     if (!handle) return 0;
     disk_file* disk = static_cast<disk_file*>(handle);
-    return disk->size;
+    return disk->store->size();
 }
 
 //=============================================================================
@@ -517,12 +546,21 @@ static int g_cursorRow = 0;
 static int g_cursorCol = 0;
 static uint8_t g_textAttr = 0x07;
 
+// Reported to HBIOS; kept equal to the terminal geometry
+static std::atomic<int> g_textRows{25};
+static std::atomic<int> g_textCols{80};
+
+extern "C" void emu_video_set_text_size(int rows, int cols) {
+    g_textRows = rows;
+    g_textCols = cols;
+}
+
 void emu_video_get_caps(emu_video_caps* caps) {
     caps->has_text_display = true;
     caps->has_pixel_display = false;
     caps->has_dsky = false;
-    caps->text_rows = 25;
-    caps->text_cols = 80;
+    caps->text_rows = g_textRows;
+    caps->text_cols = g_textCols;
     caps->pixel_width = 0;
     caps->pixel_height = 0;
 }
@@ -609,11 +647,18 @@ int emu_dsky_get_key() {
 // Host File Transfer - for R8/W8 utilities
 //=============================================================================
 
-static emu_host_file_state g_hostFileState = HOST_FILE_IDLE;
-static std::vector<uint8_t> g_hostReadBuffer;
-static size_t g_hostReadPos = 0;
-static std::vector<uint8_t> g_hostWriteBuffer;
-static std::string g_hostWriteFilename;
+// One transfer: the whole file is read on open, and a written file is
+// buffered until close
+struct HostStream {
+    emu_host_file_state state = HOST_FILE_IDLE;
+    std::vector<uint8_t> readBuffer;
+    size_t readPos = 0;
+    std::vector<uint8_t> writeBuffer;
+    std::string writeFilename;
+};
+
+static const int HOST_STREAM_COUNT = 5;  // RST 8 stream + four handles
+static HostStream g_hostStreams[HOST_STREAM_COUNT];
 static HWND g_mainWindowHwnd = nullptr;
 
 // Set main window handle for file dialogs
@@ -645,24 +690,34 @@ static std::string getDataFolder() {
     return dataDir;
 }
 
-emu_host_file_state emu_host_file_get_state() {
-    return g_hostFileState;
+// Stream 0 is the one the RST 8 functions use (emu_host_file_*); the rest
+// are handed out by emu_host_stream_open(), so several MP/M consoles can
+// each run a transfer at once.
+static HostStream& legacyStream() {
+    return g_hostStreams[0];
 }
 
-bool emu_host_file_open_read(const char* filename) {
+static HostStream* hostStream(int handle) {
+    if (handle < 0 || handle >= HOST_STREAM_COUNT) {
+        return nullptr;
+    }
+    return &g_hostStreams[handle];
+}
+
+static bool streamOpenRead(HostStream& s, const char* filename) {
     // Close any existing read operation
-    g_hostReadBuffer.clear();
-    g_hostReadPos = 0;
+    s.readBuffer.clear();
+    s.readPos = 0;
 
     if (!filename || !*filename) {
-        g_hostFileState = HOST_FILE_IDLE;
+        s.state = HOST_FILE_IDLE;
         return false;
     }
 
     // Build full path in data folder
     std::string dataFolder = getDataFolder();
     if (dataFolder.empty()) {
-        g_hostFileState = HOST_FILE_IDLE;
+        s.state = HOST_FILE_IDLE;
         return false;
     }
 
@@ -674,99 +729,200 @@ bool emu_host_file_open_read(const char* filename) {
         fseek(f, 0, SEEK_END);
         size_t size = ftell(f);
         fseek(f, 0, SEEK_SET);
-        g_hostReadBuffer.resize(size);
-        fread(g_hostReadBuffer.data(), 1, size, f);
+        s.readBuffer.resize(size);
+        fread(s.readBuffer.data(), 1, size, f);
         fclose(f);
-        g_hostFileState = HOST_FILE_READING;
+        s.state = HOST_FILE_READING;
         return true;
     }
 
-    g_hostFileState = HOST_FILE_IDLE;
+    s.state = HOST_FILE_IDLE;
     return false;
 }
 
-bool emu_host_file_open_write(const char* filename) {
-    g_hostWriteBuffer.clear();
-    g_hostWriteFilename = filename ? filename : "export.txt";
-    g_hostFileState = HOST_FILE_WRITING;
-    return true;
+static void streamOpenWrite(HostStream& s, const char* filename) {
+    s.writeBuffer.clear();
+    s.writeFilename = filename ? filename : "export.txt";
+    s.state = HOST_FILE_WRITING;
 }
 
-int emu_host_file_read_byte() {
-    if (g_hostFileState != HOST_FILE_READING) {
-        return -1;
+static size_t streamReadBlock(HostStream& s, uint8_t* data, size_t count) {
+    if (s.state != HOST_FILE_READING) {
+        return 0;
     }
 
-    if (g_hostReadPos >= g_hostReadBuffer.size()) {
-        return -1;  // EOF
+    size_t n = std::min(count, s.readBuffer.size() - s.readPos);
+    if (n > 0) {
+        memcpy(data, s.readBuffer.data() + s.readPos, n);
+        s.readPos += n;
     }
-
-    return g_hostReadBuffer[g_hostReadPos++];
+    return n;  // Short (or 0) at EOF
 }
 
-bool emu_host_file_write_byte(uint8_t byte) {
-    if (g_hostFileState != HOST_FILE_WRITING) {
+static bool streamWriteBlock(HostStream& s, const uint8_t* data, size_t count) {
+    if (s.state != HOST_FILE_WRITING) {
         return false;
     }
 
-    g_hostWriteBuffer.push_back(byte);
+    s.writeBuffer.insert(s.writeBuffer.end(), data, data + count);
     return true;
 }
 
-void emu_host_file_close_read() {
-    g_hostReadBuffer.clear();
-    g_hostReadPos = 0;
-    g_hostFileState = HOST_FILE_IDLE;
+static void streamCloseRead(HostStream& s) {
+    s.readBuffer.clear();
+    s.readPos = 0;
+    s.state = HOST_FILE_IDLE;
 }
 
-void emu_host_file_close_write() {
-    if (g_hostFileState == HOST_FILE_WRITING && !g_hostWriteBuffer.empty()) {
+static void streamCloseWrite(HostStream& s) {
+    if (s.state == HOST_FILE_WRITING && !s.writeBuffer.empty()) {
         // Get the data folder path
         std::string dataFolder = getDataFolder();
 
         // Use provided filename or default to export.txt
-        std::string filename = g_hostWriteFilename.empty() ? "export.txt" : g_hostWriteFilename;
+        std::string filename = s.writeFilename.empty() ? "export.txt" : s.writeFilename;
         std::string fullPath = dataFolder + "\\" + filename;
 
         // Write the buffer directly to the data folder
         FILE* f = fopen(fullPath.c_str(), "wb");
         if (f) {
-            fwrite(g_hostWriteBuffer.data(), 1, g_hostWriteBuffer.size(), f);
+            fwrite(s.writeBuffer.data(), 1, s.writeBuffer.size(), f);
             fclose(f);
         }
     }
 
-    g_hostWriteBuffer.clear();
-    g_hostWriteFilename.clear();
-    g_hostFileState = HOST_FILE_IDLE;
+    s.writeBuffer.clear();
+    s.writeFilename.clear();
+    s.state = HOST_FILE_IDLE;
+}
+
+emu_host_file_state emu_host_file_get_state() {
+    return legacyStream().state;
+}
+
+bool emu_host_file_open_read(const char* filename) {
+    return streamOpenRead(legacyStream(), filename);
+}
+
+bool emu_host_file_open_write(const char* filename) {
+    streamOpenWrite(legacyStream(), filename);
+    return true;
+}
+
+int emu_host_file_read_byte() {
+    HostStream& s = legacyStream();
+    if (s.state != HOST_FILE_READING) {
+        return -1;
+    }
+
+    if (s.readPos >= s.readBuffer.size()) {
+        return -1;  // EOF
+    }
+
+    return s.readBuffer[s.readPos++];
+}
+
+bool emu_host_file_write_byte(uint8_t byte) {
+    HostStream& s = legacyStream();
+    if (s.state != HOST_FILE_WRITING) {
+        return false;
+    }
+
+    s.writeBuffer.push_back(byte);
+    return true;
+}
+
+void emu_host_file_close_read() {
+    streamCloseRead(legacyStream());
+}
+
+void emu_host_file_close_write() {
+    streamCloseWrite(legacyStream());
 }
 
 void emu_host_file_provide_data(const uint8_t* data, size_t size) {
     // For providing data after file picker callback
-    g_hostReadBuffer.assign(data, data + size);
-    g_hostReadPos = 0;
+    HostStream& s = legacyStream();
+    s.readBuffer.assign(data, data + size);
+    s.readPos = 0;
     if (size > 0) {
-        g_hostFileState = HOST_FILE_READING;
+        s.state = HOST_FILE_READING;
     }
 }
 
 const uint8_t* emu_host_file_get_write_data() {
-    if (g_hostFileState != HOST_FILE_WRITING) {
+    HostStream& s = legacyStream();
+    if (s.state != HOST_FILE_WRITING) {
         return nullptr;
     }
-    return g_hostWriteBuffer.data();
+    return s.writeBuffer.data();
 }
 
 size_t emu_host_file_get_write_size() {
-    if (g_hostFileState != HOST_FILE_WRITING) {
+    HostStream& s = legacyStream();
+    if (s.state != HOST_FILE_WRITING) {
         return 0;
     }
-    return g_hostWriteBuffer.size();
+    return s.writeBuffer.size();
 }
 
 const char* emu_host_file_get_write_name() {
-    if (g_hostFileState != HOST_FILE_WRITING) {
+    HostStream& s = legacyStream();
+    if (s.state != HOST_FILE_WRITING) {
         return nullptr;
     }
-    return g_hostWriteFilename.c_str();
+    return s.writeFilename.c_str();
+}
+
+// Handle-based streams for the port 0xEE traps (see
+// EmulatorEngine::handleHostStream). Handle 0 is the RST 8 stream, so a
+// file opened with H_OPEN_R/H_OPEN_W can still be moved a block at a time.
+
+// Open a file on a free handle (1..HOST_STREAM_COUNT-1); -1 if none is free
+// or the file can't be read
+extern "C" int emu_host_stream_open(const char* filename, bool write) {
+    for (int handle = 1; handle < HOST_STREAM_COUNT; handle++) {
+        HostStream& s = g_hostStreams[handle];
+        if (s.state != HOST_FILE_IDLE) {
+            continue;
+        }
+        if (write) {
+            streamOpenWrite(s, filename);
+            return handle;
+        }
+        return streamOpenRead(s, filename) ? handle : -1;
+    }
+    return -1;
+}
+
+extern "C" size_t emu_host_stream_read_block(int handle, uint8_t* data, size_t count) {
+    HostStream* s = hostStream(handle);
+    return s ? streamReadBlock(*s, data, count) : 0;
+}
+
+extern "C" bool emu_host_stream_write_block(int handle, const uint8_t* data, size_t count) {
+    HostStream* s = hostStream(handle);
+    return s ? streamWriteBlock(*s, data, count) : false;
+}
+
+// Finish a stream: a written file goes to the data folder
+extern "C" bool emu_host_stream_close(int handle) {
+    HostStream* s = hostStream(handle);
+    if (!s || s->state == HOST_FILE_IDLE) {
+        return false;
+    }
+    if (s->state == HOST_FILE_WRITING) {
+        streamCloseWrite(*s);
+    } else {
+        streamCloseRead(*s);
+    }
+    return true;
+}
+
+// Drop every stream without writing anything (machine reset), so handles
+// left open by a program that never closed them are not lost for good
+extern "C" void emu_host_stream_reset() {
+    for (HostStream& s : g_hostStreams) {
+        s = HostStream();
+    }
 }
@@ -20,12 +20,23 @@
 #define ID_FILE_LOADPROFILE     1007
 #define ID_FILE_SAVEPROFILE     1008
 #define ID_FILE_EXIT            1010
+#define ID_FILE_COMPRESSDISK    1011
+#define ID_FILE_EXPANDDISK      1012
+#define ID_FILE_DEDUPDISK       1013
+#define ID_FILE_CLONEDISK       1014
 
 // Emulator menu
 #define ID_EMU_START            2001
 #define ID_EMU_STOP             2002
 #define ID_EMU_RESET            2003
 #define ID_EMU_SETTINGS         2004
+#define ID_EMU_PASTE            2005
+#define ID_EMU_RECORD           2006
+#define ID_EMU_REPLAY           2007
+#define ID_EMU_REPLAY_1X        2010
+#define ID_EMU_REPLAY_4X        2011
+#define ID_EMU_REPLAY_16X       2012
+#define ID_EMU_REPLAY_MAX       2013
 
 // View menu
 #define ID_VIEW_FONT14          3001
@@ -35,6 +46,14 @@
 #define ID_VIEW_FONT24          3005
 #define ID_VIEW_FONT28          3006
 #define ID_VIEW_DAZZLER         3010
+#define ID_VIEW_DAZZLER_CAPTURE 3011
+#define ID_VIEW_TERM_80X24      3020
+#define ID_VIEW_TERM_80X25      3021
+#define ID_VIEW_TERM_80X43      3022
+#define ID_VIEW_TERM_80X50      3023
+#define ID_VIEW_TERM_132X25     3024
+#define ID_VIEW_TERM_132X43     3025
+#define ID_VIEW_TERM_132X60     3026
 
 // Help menu
 #define ID_HELP_TOPICS          4000